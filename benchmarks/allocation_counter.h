@@ -0,0 +1,6 @@
+#pragma once
+
+#include <cstddef>
+
+// Number of global operator new calls, of every form, since program start
+std::size_t allocationCount();
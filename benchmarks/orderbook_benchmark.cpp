@@ -1,6 +1,26 @@
 #include <benchmark/benchmark.h>
 
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "allocation_counter.h"
+#include "workload.h"
+#include "orderbook/engine.h"
+#include "orderbook/fill_kernel.h"
+#include "orderbook/journal.h"
 #include "orderbook/orderbook.h"
+#include "orderbook/pipeline.h"
 
 template<class OrderBookPolicy>
 class OrderBookFixture : public benchmark::Fixture
@@ -21,14 +41,1341 @@ BENCHMARK_TEMPLATE_METHOD_F(OrderBookFixture, BM_AddOrder)(benchmark::State& sta
     }
 }
 
+// Rests and cancels one order behind a standing order, so the level stays
+// alive and only per-order costs are measured
+BENCHMARK_TEMPLATE_METHOD_F(OrderBookFixture, BM_AddCancel)(benchmark::State& state)
+{
+    this->orderbook_.addOrder(
+        OrderType::GoodTillCancel, OrderId{0}, Side::Buy, Price{100}, Size{10}
+    );
+    this->orderbook_.addOrder(
+        OrderType::GoodTillCancel, OrderId{1}, Side::Buy, Price{100}, Size{10}
+    );
+    this->orderbook_.cancelOrder(OrderId{1});
+
+    std::size_t allocationsBefore = allocationCount();
+
+    for (auto _ : state)
+    {
+        this->orderbook_.addOrder(
+            OrderType::GoodTillCancel, OrderId{1}, Side::Buy, Price{100}, Size{10}
+        );
+        this->orderbook_.cancelOrder(OrderId{1});
+    }
+
+    state.counters["allocs_per_op"] = benchmark::Counter(
+        static_cast<double>(allocationCount() - allocationsBefore),
+        benchmark::Counter::kAvgIterations
+    );
+}
+
+// Cancels a random order out of a level of state.range(0) orders and queues
+// it again at the back, so the level keeps its length
+BENCHMARK_TEMPLATE_METHOD_F(OrderBookFixture, BM_CancelDeepQueue)(benchmark::State& state)
+{
+    auto depth = static_cast<OrderId>(state.range(0));
+    for (OrderId id = 0; id < depth; ++id)
+    {
+        this->orderbook_.addOrder(
+            OrderType::GoodTillCancel, id, Side::Buy, Price{100}, Size{10}
+        );
+    }
+
+    std::mt19937_64 rng{42};
+
+    for (auto _ : state)
+    {
+        OrderId id = rng() % depth;
+        this->orderbook_.cancelOrder(id);
+        this->orderbook_.addOrder(
+            OrderType::GoodTillCancel, id, Side::Buy, Price{100}, Size{10}
+        );
+    }
+}
+
+// Cancels a random order out of state.range(0) levels, each of which keeps a
+// second order, and queues it again, so levels are found but never erased
+BENCHMARK_TEMPLATE_METHOD_F(OrderBookFixture, BM_CancelAcrossLevels)(benchmark::State& state)
+{
+    auto levels = static_cast<OrderId>(state.range(0));
+    for (OrderId level = 0; level < levels; ++level)
+    {
+        auto price = static_cast<Price>(100 + level);
+        this->orderbook_.addOrder(
+            OrderType::GoodTillCancel, 2 * level, Side::Buy, price, Size{10}
+        );
+        this->orderbook_.addOrder(
+            OrderType::GoodTillCancel, 2 * level + 1, Side::Buy, price, Size{10}
+        );
+    }
+
+    std::mt19937_64 rng{42};
+
+    for (auto _ : state)
+    {
+        OrderId level = rng() % levels;
+        auto price = static_cast<Price>(100 + level);
+        this->orderbook_.cancelOrder(2 * level + 1);
+        this->orderbook_.addOrder(
+            OrderType::GoodTillCancel, 2 * level + 1, Side::Buy, price, Size{10}
+        );
+    }
+}
+
+// Opens and closes a level at a random price among state.range(0) standing
+// levels, so the level container inserts and erases all through its range
+BENCHMARK_TEMPLATE_METHOD_F(OrderBookFixture, BM_LevelChurn)(benchmark::State& state)
+{
+    auto levels = static_cast<OrderId>(state.range(0));
+    for (OrderId level = 0; level < levels; ++level)
+    {
+        this->orderbook_.addOrder(
+            OrderType::GoodTillCancel, level, Side::Buy, static_cast<Price>(100 + 2 * level), Size{10}
+        );
+    }
+
+    std::mt19937_64 rng{42};
+
+    for (auto _ : state)
+    {
+        auto price = static_cast<Price>(101 + 2 * (rng() % levels));
+        this->orderbook_.addOrder(
+            OrderType::GoodTillCancel, levels, Side::Buy, price, Size{10}
+        );
+        this->orderbook_.cancelOrder(levels);
+    }
+}
+
+// Keeps state.range(0) one-lot bid levels and moves the band up a tick at a
+// time, opening a level above it and closing the one at its foot, so prices
+// keep drifting past any fixed window
+BENCHMARK_TEMPLATE_METHOD_F(OrderBookFixture, BM_PriceDrift)(benchmark::State& state)
+{
+    auto levels = static_cast<Price>(state.range(0));
+    Price top = 1000;
+    for (Price price = top - levels + 1; price <= top; ++price)
+    {
+        this->orderbook_.addOrder(
+            OrderType::GoodTillCancel, static_cast<OrderId>(price), Side::Buy, price, Size{1}
+        );
+    }
+
+    for (auto _ : state)
+    {
+        ++top;
+        this->orderbook_.addOrder(
+            OrderType::GoodTillCancel, static_cast<OrderId>(top), Side::Buy, top, Size{1}
+        );
+        this->orderbook_.cancelOrder(static_cast<OrderId>(top - levels));
+    }
+}
+
+// Amends an order down by one lot at a time behind a standing order, which
+// stays in place, against moving it between two prices, which requeues
+BENCHMARK_TEMPLATE_METHOD_F(OrderBookFixture, BM_AmendDown)(benchmark::State& state)
+{
+    Size size = Size{1} << 40;
+    this->orderbook_.addOrder(
+        OrderType::GoodTillCancel, OrderId{0}, Side::Buy, Price{100}, Size{10}
+    );
+    this->orderbook_.addOrder(
+        OrderType::GoodTillCancel, OrderId{1}, Side::Buy, Price{100}, size
+    );
+
+    for (auto _ : state)
+    {
+        this->orderbook_.modifyOrder(
+            OrderType::GoodTillCancel, OrderId{1}, Side::Buy, Price{100}, --size,
+            [](const Trade&) {}
+        );
+    }
+}
+
+BENCHMARK_TEMPLATE_METHOD_F(OrderBookFixture, BM_Reprice)(benchmark::State& state)
+{
+    Price price = 100;
+    this->orderbook_.addOrder(
+        OrderType::GoodTillCancel, OrderId{0}, Side::Buy, Price{100}, Size{10}
+    );
+    this->orderbook_.addOrder(
+        OrderType::GoodTillCancel, OrderId{1}, Side::Buy, price, Size{10}
+    );
+
+    for (auto _ : state)
+    {
+        price = price == 100 ? 101 : 100;
+        this->orderbook_.modifyOrder(
+            OrderType::GoodTillCancel, OrderId{1}, Side::Buy, price, Size{10},
+            [](const Trade&) {}
+        );
+    }
+}
+
+// BM_AddCancel publishing depth, with one batch per add/cancel pair
+BENCHMARK_TEMPLATE_METHOD_F(OrderBookFixture, BM_AddCancelDepth)(benchmark::State& state)
+{
+    this->orderbook_.addOrder(
+        OrderType::GoodTillCancel, OrderId{0}, Side::Buy, Price{100}, Size{10}
+    );
+
+    for (auto _ : state)
+    {
+        this->orderbook_.addOrder(
+            OrderType::GoodTillCancel, OrderId{1}, Side::Buy, Price{100}, Size{10}
+        );
+        this->orderbook_.cancelOrder(OrderId{1});
+        benchmark::DoNotOptimize(this->orderbook_.depthListener().updates().size());
+        this->orderbook_.depthListener().clear();
+    }
+}
+
+struct ConflatedDepthFeed : DepthFeed
+{
+    ConflatedDepthFeed() : DepthFeed{true} {}
+};
+
+// BM_AddCancel writing both commands to a MappedJournal flushed every
+// state.range(0) records, or never for 0
+constexpr std::size_t journalIterations = 1 << 18;
+
+std::string journalPath()
+{
+    return (std::filesystem::temp_directory_path() / "orderbook_benchmark.journal").string();
+}
+
+using JournaledBook = OrderBook<ArrayLevelPolicy, IntrusiveOrderPolicy, PoolOrderAllocator,
+                                FlatOrderIndex, NullDepthListener, NullOrderEventListener,
+                                MappedJournal>;
+
+void BM_AddCancelJournal(benchmark::State& state)
+{
+    std::filesystem::remove(journalPath());
+    {
+        JournaledBook book{
+            NullDepthListener{}, NullOrderEventListener{},
+            MappedJournal{journalPath(), 2 * journalIterations + 1,
+                          static_cast<std::size_t>(state.range(0))}
+        };
+
+        book.addOrder(OrderType::GoodTillCancel, OrderId{0}, Side::Buy, Price{100}, Size{10});
+
+        for (auto _ : state)
+        {
+            book.addOrder(OrderType::GoodTillCancel, OrderId{1}, Side::Buy, Price{100}, Size{10});
+            book.cancelOrder(OrderId{1});
+        }
+    }
+    std::filesystem::remove(journalPath());
+}
+
+// Replays a journal of crossing adds into an empty book
+void BM_JournalReplay(benchmark::State& state)
+{
+    std::filesystem::remove(journalPath());
+    {
+        MappedJournal journal{journalPath(), journalIterations, 0};
+        for (OrderId id = 0; id < journalIterations; ++id)
+        {
+            journal.record(Command{
+                CommandType::Add, OrderType::GoodTillCancel, id % 2 ? Side::Buy : Side::Sell,
+                SymbolId{}, id, Price{100} + static_cast<Price>(id % 8), Size{10}
+            });
+        }
+    }
+
+    for (auto _ : state)
+    {
+        OrderBook<ArrayLevelPolicy, IntrusiveOrderPolicy, PoolOrderAllocator, FlatOrderIndex> book;
+        benchmark::DoNotOptimize(MappedJournal::replayInto(journalPath(), book));
+    }
+
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * journalIterations));
+    std::filesystem::remove(journalPath());
+}
+
+BENCHMARK(BM_AddCancelJournal)->Arg(0)->Arg(1024)->Iterations(journalIterations);
+BENCHMARK(BM_JournalReplay)->Unit(benchmark::kMillisecond);
+
+// Rests an ask and crosses it, collecting the execution as a Trades vector
+BENCHMARK_TEMPLATE_METHOD_F(OrderBookFixture, BM_CrossTrades)(benchmark::State& state)
+{
+    OrderId id = 0;
+    std::size_t allocationsBefore = allocationCount();
+
+    for (auto _ : state)
+    {
+        this->orderbook_.addOrder(
+            OrderType::GoodTillCancel, ++id, Side::Sell, Price{100}, Size{10}
+        );
+        benchmark::DoNotOptimize(this->orderbook_.addOrder(
+            OrderType::GoodTillCancel, ++id, Side::Buy, Price{100}, Size{10}
+        ));
+    }
+
+    state.counters["allocs_per_op"] = benchmark::Counter(
+        static_cast<double>(allocationCount() - allocationsBefore),
+        benchmark::Counter::kAvgIterations
+    );
+}
+
+// Same flow as BM_CrossTrades with executions written to a preallocated span
+BENCHMARK_TEMPLATE_METHOD_F(OrderBookFixture, BM_CrossSink)(benchmark::State& state)
+{
+    std::array<Trade, 16> storage;
+    SpanTradeSink sink{storage};
+    OrderId id = 0;
+    std::size_t allocationsBefore = allocationCount();
+
+    for (auto _ : state)
+    {
+        sink.clear();
+        this->orderbook_.addOrder(
+            OrderType::GoodTillCancel, ++id, Side::Sell, Price{100}, Size{10}, sink
+        );
+        this->orderbook_.addOrder(
+            OrderType::GoodTillCancel, ++id, Side::Buy, Price{100}, Size{10}, sink
+        );
+        benchmark::DoNotOptimize(sink.count());
+    }
+
+    state.counters["allocs_per_op"] = benchmark::Counter(
+        static_cast<double>(allocationCount() - allocationsBefore),
+        benchmark::Counter::kAvgIterations
+    );
+}
+
+// BM_CrossSink also recording market-by-order events, one batch per cross
+BENCHMARK_TEMPLATE_METHOD_F(OrderBookFixture, BM_CrossEvents)(benchmark::State& state)
+{
+    std::array<Trade, 16> storage;
+    SpanTradeSink sink{storage};
+    OrderId id = 0;
+
+    for (auto _ : state)
+    {
+        sink.clear();
+        this->orderbook_.orderEventListener().clear();
+        this->orderbook_.addOrder(
+            OrderType::GoodTillCancel, ++id, Side::Sell, Price{100}, Size{10}, sink
+        );
+        this->orderbook_.addOrder(
+            OrderType::GoodTillCancel, ++id, Side::Buy, Price{100}, Size{10}, sink
+        );
+        benchmark::DoNotOptimize(this->orderbook_.orderEventListener().count());
+    }
+}
+
+// BM_CrossSink with the order type fixed at compile time
+BENCHMARK_TEMPLATE_METHOD_F(OrderBookFixture, BM_CrossTyped)(benchmark::State& state)
+{
+    std::array<Trade, 16> storage;
+    SpanTradeSink sink{storage};
+    OrderId id = 0;
+
+    for (auto _ : state)
+    {
+        sink.clear();
+        this->orderbook_.template addOrder<OrderType::GoodTillCancel>(
+            ++id, Side::Sell, Price{100}, Size{10}, sink
+        );
+        this->orderbook_.template addOrder<OrderType::GoodTillCancel>(
+            ++id, Side::Buy, Price{100}, Size{10}, sink
+        );
+        benchmark::DoNotOptimize(sink.count());
+    }
+}
+
+// Rests one ask every state.range(0) ticks, so consecutive levels are
+// separated by that many empty ticks
+constexpr OrderId sparseLevels = 64;
+
+template<class OrderBookPolicy>
+void restSparseAsks(OrderBookPolicy& orderbook, Price spacing)
+{
+    for (OrderId id = 1; id <= sparseLevels; ++id)
+    {
+        orderbook.addOrder(
+            OrderType::GoodTillCancel, id, Side::Sell,
+            Price{100000} + static_cast<Price>(id) * spacing, Size{10}
+        );
+    }
+}
+
+template<class OrderBookPolicy>
+void clearSparseAsks(OrderBookPolicy& orderbook)
+{
+    for (OrderId id = 1; id <= sparseLevels; ++id)
+    {
+        orderbook.cancelOrder(id);
+    }
+}
+
+// Fill-or-kill that needs one lot more than the book holds, so every level
+// is visited by canFullyFill and the book is left untouched
+BENCHMARK_TEMPLATE_METHOD_F(OrderBookFixture, BM_SparseFillCheck)(benchmark::State& state)
+{
+    restSparseAsks(this->orderbook_, state.range(0));
+    Price limit = Price{100000} + static_cast<Price>(sparseLevels + 1) * state.range(0);
+    OrderId id = sparseLevels;
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(this->orderbook_.addOrder(
+            OrderType::FillOrKill, ++id, Side::Buy, limit, Size{sparseLevels * 10 + 1}
+        ));
+    }
+
+    clearSparseAsks(this->orderbook_);
+}
+
+// Rests deepOrders asks on each of sparseLevels adjacent levels, with an
+// AllOrNone order at the back of every level
+constexpr OrderId deepOrders = 16;
+
+template<class OrderBookPolicy>
+void restDeepAsks(OrderBookPolicy& orderbook)
+{
+    OrderId id = 0;
+    for (Price price = 1; price <= static_cast<Price>(sparseLevels); ++price)
+    {
+        for (OrderId i = 1; i < deepOrders; ++i)
+        {
+            orderbook.addOrder(
+                OrderType::GoodTillCancel, ++id, Side::Sell, Price{100000} + price, Size{10}
+            );
+        }
+        orderbook.addOrder(
+            OrderType::AllOrNone, ++id, Side::Sell, Price{100000} + price, Size{10}
+        );
+    }
+}
+
+// Fill-or-kill checks against a deep book: state.range(0) is the volume
+// asked for, either the whole book plus one lot (killed) or half of it
+BENCHMARK_TEMPLATE_METHOD_F(OrderBookFixture, BM_DeepFillCheck)(benchmark::State& state)
+{
+    restDeepAsks(this->orderbook_);
+    Price limit = Price{100000} + static_cast<Price>(sparseLevels);
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(this->orderbook_.canFullyFill(
+            Side::Buy, limit, static_cast<Size>(state.range(0))
+        ));
+    }
+}
+
+// Rests fillLevels adjacent ask levels of fillLevelOrders one-lot orders,
+// each level behind an AllOrNone order too large to ever fill, so the fill
+// check has to walk every level it reaches
+constexpr Price fillLevels = 50;
+constexpr OrderId fillLevelOrders = 64;
+
+template<class OrderBookPolicy>
+void restBlockedAsks(OrderBookPolicy& orderbook)
+{
+    OrderId id = 0;
+    for (Price price = 1; price <= fillLevels; ++price)
+    {
+        orderbook.addOrder(
+            OrderType::AllOrNone, ++id, Side::Sell, Price{100000} + price, Size{1} << 30
+        );
+        for (OrderId i = 0; i < fillLevelOrders; ++i)
+        {
+            orderbook.addOrder(
+                OrderType::GoodTillCancel, ++id, Side::Sell, Price{100000} + price, Size{1}
+            );
+        }
+    }
+}
+
+// Fill-or-kill limited to the first state.range(0) levels, one lot more
+// than they hold, so each of them is checked and the order is killed
+BENCHMARK_TEMPLATE_METHOD_F(OrderBookFixture, BM_FillCheckSweep)(benchmark::State& state)
+{
+    restBlockedAsks(this->orderbook_);
+    Price limit = Price{100000} + state.range(0);
+    Size volume = static_cast<Size>(state.range(0)) * fillLevelOrders + 1;
+    OrderId id = fillLevels * (fillLevelOrders + 1);
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(this->orderbook_.addOrder(
+            OrderType::FillOrKill, ++id, Side::Buy, limit, volume
+        ));
+    }
+}
+
+// Fill-or-kill one lot short of reaching past an AllOrNone order that sits
+// behind state.range(0) one-lot orders, so the whole queue ahead of it is
+// summed and the order is killed
+BENCHMARK_TEMPLATE_METHOD_F(OrderBookFixture, BM_QueuedAllOrNoneFillCheck)(benchmark::State& state)
+{
+    auto queued = static_cast<OrderId>(state.range(0));
+    for (OrderId id = 1; id <= queued; ++id)
+    {
+        this->orderbook_.addOrder(
+            OrderType::GoodTillCancel, id, Side::Sell, Price{100}, Size{1}
+        );
+    }
+    this->orderbook_.addOrder(
+        OrderType::AllOrNone, queued + 1, Side::Sell, Price{100}, Size{2}
+    );
+
+    OrderId id = queued + 1;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(this->orderbook_.addOrder(
+            OrderType::FillOrKill, ++id, Side::Buy, Price{100}, Size{queued + 1}
+        ));
+    }
+}
+
+// Rests state.range(0) AllOrNone asks too large to fill at one price, then
+// trades a one-lot ask queued behind them, so each match looks past them
+BENCHMARK_TEMPLATE_METHOD_F(OrderBookFixture, BM_AllOrNoneDepthMatch)(benchmark::State& state)
+{
+    auto resting = static_cast<OrderId>(state.range(0));
+    for (OrderId id = 1; id <= resting; ++id)
+    {
+        this->orderbook_.addOrder(
+            OrderType::AllOrNone, id, Side::Sell, Price{100}, Size{1} << 30
+        );
+    }
+
+    OrderId id = resting;
+    for (auto _ : state)
+    {
+        this->orderbook_.addOrder(OrderType::GoodTillCancel, ++id, Side::Sell, Price{100}, Size{1});
+        benchmark::DoNotOptimize(this->orderbook_.addOrder(
+            OrderType::FillAndKill, ++id, Side::Buy, Price{100}, Size{1}
+        ));
+    }
+}
+
+// Keeps state.range(0) AllOrNone asks at one price, adding one at the back
+// and cancelling the oldest each iteration
+BENCHMARK_TEMPLATE_METHOD_F(OrderBookFixture, BM_AllOrNoneDepthCancel)(benchmark::State& state)
+{
+    auto resting = static_cast<OrderId>(state.range(0));
+    for (OrderId id = 1; id <= resting; ++id)
+    {
+        this->orderbook_.addOrder(
+            OrderType::AllOrNone, id, Side::Sell, Price{100}, Size{1} << 30
+        );
+    }
+
+    OrderId id = resting;
+    for (auto _ : state)
+    {
+        this->orderbook_.addOrder(OrderType::AllOrNone, ++id, Side::Sell, Price{100}, Size{1} << 30);
+        this->orderbook_.cancelOrder(id - resting);
+    }
+}
+
+// The sumSizes kernels alone over state.range(0) one-lot sizes
+template<SumSizesFunction Kernel>
+void BM_FillSizes(benchmark::State& state)
+{
+    auto count = static_cast<std::size_t>(state.range(0));
+    std::vector<Size> sizes(count, Size{1});
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(Kernel(sizes.data(), count));
+    }
+
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * count));
+}
+
+BENCHMARK_TEMPLATE(BM_FillSizes, sumSizesScalar)->Arg(64)->Arg(3200);
+#if defined(__x86_64__)
+BENCHMARK_TEMPLATE(BM_FillSizes, sumSizesAvx2)->Arg(64)->Arg(3200);
+#endif
+
+// Sweeps every sparse level with a market order, then rests them again
+BENCHMARK_TEMPLATE_METHOD_F(OrderBookFixture, BM_SparseSweep)(benchmark::State& state)
+{
+    OrderId id = sparseLevels;
+
+    for (auto _ : state)
+    {
+        restSparseAsks(this->orderbook_, state.range(0));
+        benchmark::DoNotOptimize(this->orderbook_.addOrder(
+            OrderType::Market, ++id, Side::Buy, Price{MARKET_PRICE},
+            Size{sparseLevels * 10}
+        ));
+    }
+}
+
+// Id index microbenchmarks over state.range(0) live keys. Ids are spread
+// with a fixed seed so neighbouring keys do not share a cache line
+template<class OrderIndex>
+std::vector<OrderId> fillIndex(OrderIndex& index, std::size_t count)
+{
+    std::mt19937_64 rng{42};
+    std::vector<OrderId> ids(count);
+
+    for (auto& id : ids)
+    {
+        id = rng();
+        index[id] = nullptr;
+    }
+    return ids;
+}
+
+template<class OrderIndex>
+void BM_IndexLookup(benchmark::State& state)
+{
+    OrderIndex index;
+    auto ids = fillIndex(index, static_cast<std::size_t>(state.range(0)));
+    std::size_t i = 0;
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(index.find(ids[i]));
+        i = i + 1 == ids.size() ? 0 : i + 1;
+    }
+}
+
+template<class OrderIndex>
+void BM_IndexLookupMiss(benchmark::State& state)
+{
+    OrderIndex index;
+    fillIndex(index, static_cast<std::size_t>(state.range(0)));
+    OrderId id = 0;
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(index.find(++id));
+    }
+}
+
+// Erases a live id and inserts it again, so the size stays constant
+template<class OrderIndex>
+void BM_IndexEraseInsert(benchmark::State& state)
+{
+    OrderIndex index;
+    auto ids = fillIndex(index, static_cast<std::size_t>(state.range(0)));
+    std::size_t i = 0;
+    std::size_t allocationsBefore = allocationCount();
+
+    for (auto _ : state)
+    {
+        index.erase(ids[i]);
+        index[ids[i]] = nullptr;
+        i = i + 1 == ids.size() ? 0 : i + 1;
+    }
+
+    state.counters["allocs_per_op"] = benchmark::Counter(
+        static_cast<double>(allocationCount() - allocationsBefore),
+        benchmark::Counter::kAvgIterations
+    );
+}
+
+using StdOrderIndex = std::unordered_map<OrderId, OrderPointer>;
+
+BENCHMARK_TEMPLATE(BM_IndexLookup, StdOrderIndex)->Arg(1 << 10)->Arg(1 << 20);
+BENCHMARK_TEMPLATE(BM_IndexLookup, FlatOrderIndex)->Arg(1 << 10)->Arg(1 << 20);
+BENCHMARK_TEMPLATE(BM_IndexLookupMiss, StdOrderIndex)->Arg(1 << 10)->Arg(1 << 20);
+BENCHMARK_TEMPLATE(BM_IndexLookupMiss, FlatOrderIndex)->Arg(1 << 10)->Arg(1 << 20);
+BENCHMARK_TEMPLATE(BM_IndexEraseInsert, StdOrderIndex)->Arg(1 << 10)->Arg(1 << 20);
+BENCHMARK_TEMPLATE(BM_IndexEraseInsert, FlatOrderIndex)->Arg(1 << 10)->Arg(1 << 20);
+
+// Submits crossing buy/sell pairs round-robin over engineSymbols symbols
+// from this thread to state.range(0) shards, draining once per iteration
+constexpr SymbolId engineSymbols = 1024;
+constexpr std::size_t engineBatch = 1 << 16;
+
+void BM_EngineThroughput(benchmark::State& state)
+{
+    using Book = OrderBook<MapLevelPolicy, IntrusiveOrderPolicy, PoolOrderAllocator, FlatOrderIndex>;
+    MatchingEngine<Book> engine{static_cast<std::size_t>(state.range(0))};
+    OrderId id = 0;
+
+    for (auto _ : state)
+    {
+        for (std::size_t i = 0; i < engineBatch; ++i)
+        {
+            engine.submit(Command{
+                CommandType::Add, OrderType::GoodTillCancel, i % 2 ? Side::Buy : Side::Sell,
+                static_cast<SymbolId>((i / 2) % engineSymbols), ++id, Price{100}, Size{10}
+            });
+        }
+        engine.drain();
+    }
+
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * engineBatch));
+}
+
+BENCHMARK(BM_EngineThroughput)->Apply([](benchmark::internal::Benchmark* bench)
+{
+    int cores = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    for (int shards = 1; shards < cores; shards *= 2)
+    {
+        bench->Arg(shards);
+    }
+    bench->Arg(cores);
+})->UseRealTime();
+
+// Direct calls versus the matching thread of an OrderPipeline, on the same
+// crossing buy/sell flow
+using PipelineBook = OrderBook<MapLevelPolicy, IntrusiveOrderPolicy, PoolOrderAllocator, FlatOrderIndex>;
+constexpr std::size_t pipelineBatch = 1 << 12;
+
+Command crossingAdd(OrderId id)
+{
+    return Command{
+        CommandType::Add, OrderType::GoodTillCancel, id % 2 ? Side::Buy : Side::Sell,
+        SymbolId{}, id, Price{100}, Size{10}
+    };
+}
+
+void BM_DirectThroughput(benchmark::State& state)
+{
+    PipelineBook book;
+    std::size_t trades = 0;
+    OrderId id = 0;
+
+    for (auto _ : state)
+    {
+        for (std::size_t i = 0; i < pipelineBatch; ++i)
+        {
+            crossingAdd(++id).applyTo(book, [&](const Trade&) { ++trades; });
+        }
+    }
+
+    benchmark::DoNotOptimize(trades);
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * pipelineBatch));
+}
+
+// Submits a batch while polling results, until every result is back
+void BM_PipelineThroughput(benchmark::State& state)
+{
+    OrderPipeline<PipelineBook> pipeline;
+    OrderId id = 0;
+
+    for (auto _ : state)
+    {
+        std::size_t submitted = 0;
+        std::size_t received = 0;
+
+        while (received < pipelineBatch)
+        {
+            while (submitted < pipelineBatch && pipeline.trySubmit(0, crossingAdd(id + 1)))
+            {
+                ++id;
+                ++submitted;
+            }
+            received += pipeline.pollResults(0, pipelineBatch, [](const CommandResult&) {});
+        }
+    }
+
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * pipelineBatch));
+}
+
+void BM_DirectRoundTrip(benchmark::State& state)
+{
+    PipelineBook book;
+    OrderId id = 0;
+
+    for (auto _ : state)
+    {
+        std::size_t trades = 0;
+        crossingAdd(++id).applyTo(book, [&](const Trade&) { ++trades; });
+        benchmark::DoNotOptimize(trades);
+    }
+}
+
+// One command at a time: submit, then spin until its result comes back
+void BM_PipelineRoundTrip(benchmark::State& state)
+{
+    OrderPipeline<PipelineBook> pipeline;
+    OrderId id = 0;
+
+    for (auto _ : state)
+    {
+        pipeline.submit(0, crossingAdd(++id));
+        while (pipeline.pollResults(0, 1, [](const CommandResult&) {}) == 0)
+        {
+        }
+    }
+}
+
+BENCHMARK(BM_DirectThroughput);
+BENCHMARK(BM_PipelineThroughput)->UseRealTime();
+BENCHMARK(BM_DirectRoundTrip);
+BENCHMARK(BM_PipelineRoundTrip)->UseRealTime();
+
+// Snapshot and restore of books holding state.range(0) resting orders over
+// 1024 levels a side, against rebuilding the same book with addOrder
+template<class Book>
+void fillDeepBook(Book& book, std::size_t count)
+{
+    book.reserve(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        auto side = i % 2 ? Side::Buy : Side::Sell;
+        auto offset = static_cast<Price>((i / 2) % 1024);
+        book.addOrder(OrderType::GoodTillCancel, OrderId{i}, side,
+                      side == Side::Buy ? Price{10000} - offset : Price{10001} + offset,
+                      Size{10});
+    }
+}
+
+template<class Book>
+void BM_Snapshot(benchmark::State& state)
+{
+    auto count = static_cast<std::size_t>(state.range(0));
+    Book book;
+    fillDeepBook(book, count);
+
+    for (auto _ : state)
+    {
+        auto snapshot = book.snapshot();
+        benchmark::DoNotOptimize(snapshot.data());
+    }
+
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * count));
+}
+
+template<class Book>
+void BM_Restore(benchmark::State& state)
+{
+    auto count = static_cast<std::size_t>(state.range(0));
+    std::vector<std::byte> snapshot;
+    {
+        Book source;
+        fillDeepBook(source, count);
+        snapshot = source.snapshot();
+    }
+
+    for (auto _ : state)
+    {
+        auto book = std::make_unique<Book>();
+        book->restore(snapshot);
+        benchmark::DoNotOptimize(book.get());
+
+        state.PauseTiming();
+        book.reset();
+        state.ResumeTiming();
+    }
+
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * count));
+    state.counters["bytes_per_order"] =
+        static_cast<double>(snapshot.size()) / static_cast<double>(count);
+}
+
+template<class Book>
+void BM_RebuildByAdd(benchmark::State& state)
+{
+    auto count = static_cast<std::size_t>(state.range(0));
+
+    for (auto _ : state)
+    {
+        auto book = std::make_unique<Book>();
+        fillDeepBook(*book, count);
+        benchmark::DoNotOptimize(book.get());
+
+        state.PauseTiming();
+        book.reset();
+        state.ResumeTiming();
+    }
+
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * count));
+}
+
+using SnapshotMapBook = OrderBook<MapLevelPolicy, IntrusiveOrderPolicy, PoolOrderAllocator, FlatOrderIndex>;
+using SnapshotArrayBook = OrderBook<ArrayLevelPolicy, IntrusiveOrderPolicy, PoolOrderAllocator, FlatOrderIndex>;
+using SnapshotVectorBook = OrderBook<VectorLevelPolicy, VectorOrderPolicy>;
+using SnapshotListBook = OrderBook<ListLevelPolicy, ListOrderPolicy>;
+using SnapshotChunkedBook = OrderBook<ChunkedLevelPolicy, IntrusiveOrderPolicy, PoolOrderAllocator, FlatOrderIndex>;
+
+BENCHMARK_TEMPLATE(BM_Snapshot, SnapshotMapBook)->Arg(1 << 20)->Arg(1 << 22)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_Snapshot, SnapshotArrayBook)->Arg(1 << 20)->Arg(1 << 22)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_Snapshot, SnapshotVectorBook)->Arg(1 << 20)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_Snapshot, SnapshotListBook)->Arg(1 << 20)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_Snapshot, SnapshotChunkedBook)->Arg(1 << 20)->Arg(1 << 22)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_Restore, SnapshotMapBook)->Arg(1 << 20)->Arg(1 << 22)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_Restore, SnapshotArrayBook)->Arg(1 << 20)->Arg(1 << 22)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_Restore, SnapshotVectorBook)->Arg(1 << 20)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_Restore, SnapshotListBook)->Arg(1 << 20)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_Restore, SnapshotChunkedBook)->Arg(1 << 20)->Arg(1 << 22)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_RebuildByAdd, SnapshotMapBook)->Arg(1 << 20)->Arg(1 << 22)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_RebuildByAdd, SnapshotArrayBook)->Arg(1 << 20)->Arg(1 << 22)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_RebuildByAdd, SnapshotVectorBook)->Arg(1 << 20)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_RebuildByAdd, SnapshotListBook)->Arg(1 << 20)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_RebuildByAdd, SnapshotChunkedBook)->Arg(1 << 20)->Arg(1 << 22)->Unit(benchmark::kMillisecond);
+
+// Closes a session on top of a book of 1M resting orders by expiring
+// state.range(0) GoodForDay orders, with one expire call or one cancelOrder
+// per order. They sit eight to a level of their own, or with Mixed behind
+// the 512 resting orders of each of the best 16 bid levels, which keep
+// those when the session closes
+template<class Book, bool Expire, bool Mixed = false>
+void BM_SessionClose(benchmark::State& state)
+{
+    auto count = static_cast<OrderId>(state.range(0));
+    auto book = std::make_unique<Book>();
+    fillDeepBook(*book, 1 << 20);
+    book->reserve((1 << 20) + count);
+    book->setSessionClose(Timestamp{1});
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        for (OrderId i = 0; i < count; ++i)
+        {
+            auto price = Mixed ? Price{9999} - static_cast<Price>(i % 16)
+                               : static_cast<Price>(5000 - i / 8);
+            book->addOrder(OrderType::GoodForDay, (1 << 20) + i, Side::Buy, price, Size{10});
+        }
+        state.ResumeTiming();
+
+        if constexpr (Expire)
+        {
+            benchmark::DoNotOptimize(book->expire(Timestamp{1}));
+        }
+        else
+        {
+            for (OrderId i = 0; i < count; ++i)
+            {
+                book->cancelOrder((1 << 20) + i);
+            }
+        }
+    }
+
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * count));
+}
+
+using SessionIntrusiveBook = OrderBook<ArrayLevelPolicy, IntrusiveOrderPolicy, PoolOrderAllocator, FlatOrderIndex>;
+using SessionDequeBook = OrderBook<MapLevelPolicy, DequeOrderPolicy, PoolOrderAllocator, FlatOrderIndex>;
+
+BENCHMARK_TEMPLATE(BM_SessionClose, SessionIntrusiveBook, false)->Arg(1 << 10)->Arg(1 << 16);
+BENCHMARK_TEMPLATE(BM_SessionClose, SessionIntrusiveBook, true)->Arg(1 << 10)->Arg(1 << 16);
+BENCHMARK_TEMPLATE(BM_SessionClose, SessionDequeBook, false)->Arg(1 << 10)->Arg(1 << 16);
+BENCHMARK_TEMPLATE(BM_SessionClose, SessionDequeBook, true)->Arg(1 << 10)->Arg(1 << 16);
+BENCHMARK_TEMPLATE(BM_SessionClose, SessionDequeBook, true, true)->Arg(1 << 10)->Arg(1 << 14);
+
+// Adds and cancels bursts of 256 orders with random ids on top of a book of
+// 1M resting orders, one call per order or one batch call per burst. Burst
+// orders land on random levels, or with Grouped on four levels in turn, as
+// a mass cancel would send them
+constexpr std::size_t burstSize = 256;
+
+template<class Book, bool Batched, bool Grouped>
+void BM_Burst(benchmark::State& state)
+{
+    std::mt19937_64 rng{42};
+    auto book = std::make_unique<Book>();
+    book->reserve((1 << 20) + burstSize);
+    for (std::size_t i = 0; i < (1 << 20); ++i)
+    {
+        auto side = i % 2 ? Side::Buy : Side::Sell;
+        auto offset = static_cast<Price>(rng() % 1024);
+        book->addOrder(OrderType::GoodTillCancel, rng(), side,
+                       side == Side::Buy ? Price{10000} - offset : Price{10001} + offset,
+                       Size{10});
+    }
+
+    std::vector<std::vector<Command>> bursts(64);
+    std::vector<std::vector<OrderId>> ids(bursts.size());
+    for (std::size_t b = 0; b < bursts.size(); ++b)
+    {
+        for (std::size_t i = 0; i < burstSize; ++i)
+        {
+            auto side = i % 2 ? Side::Buy : Side::Sell;
+            auto offset = static_cast<Price>(Grouped ? i * 4 / burstSize : rng() % 64);
+            OrderId id = rng();
+            bursts[b].push_back(Command{
+                CommandType::Add, OrderType::GoodTillCancel, side, SymbolId{}, id,
+                side == Side::Buy ? Price{10000} - offset : Price{10001} + offset, Size{10}
+            });
+            ids[b].push_back(id);
+        }
+    }
+
+    std::size_t b = 0;
+    for (auto _ : state)
+    {
+        if constexpr (Batched)
+        {
+            book->addOrders(bursts[b], [](const Trade&) {});
+            book->cancelOrders(ids[b]);
+        }
+        else
+        {
+            for (const auto& command : bursts[b])
+            {
+                book->addOrder(command.orderType_, command.orderId_, command.side_,
+                               command.price_, command.volume_, [](const Trade&) {});
+            }
+            for (auto id : ids[b])
+            {
+                book->cancelOrder(id);
+            }
+        }
+        b = (b + 1) % bursts.size();
+    }
+
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * burstSize));
+}
+
+using BurstMapBook = OrderBook<MapLevelPolicy, IntrusiveOrderPolicy, PoolOrderAllocator, FlatOrderIndex>;
+using BurstArrayBook = OrderBook<ArrayLevelPolicy, IntrusiveOrderPolicy, PoolOrderAllocator, FlatOrderIndex>;
+using BurstVectorBook = OrderBook<VectorLevelPolicy, VectorOrderPolicy>;
+
+BENCHMARK_TEMPLATE(BM_Burst, BurstMapBook, false, false);
+BENCHMARK_TEMPLATE(BM_Burst, BurstMapBook, true, false);
+BENCHMARK_TEMPLATE(BM_Burst, BurstMapBook, false, true);
+BENCHMARK_TEMPLATE(BM_Burst, BurstMapBook, true, true);
+BENCHMARK_TEMPLATE(BM_Burst, BurstArrayBook, false, false);
+BENCHMARK_TEMPLATE(BM_Burst, BurstArrayBook, true, false);
+BENCHMARK_TEMPLATE(BM_Burst, BurstArrayBook, false, true);
+BENCHMARK_TEMPLATE(BM_Burst, BurstArrayBook, true, true);
+BENCHMARK_TEMPLATE(BM_Burst, BurstVectorBook, false, false);
+BENCHMARK_TEMPLATE(BM_Burst, BurstVectorBook, true, false);
+BENCHMARK_TEMPLATE(BM_Burst, BurstVectorBook, false, true);
+BENCHMARK_TEMPLATE(BM_Burst, BurstVectorBook, true, true);
+
+// Scenario benchmarks replaying a generated flow of workloadLength commands,
+// one command per iteration. The book is rebuilt, untimed, whenever the
+// flow runs out
+constexpr std::size_t workloadLength = 1 << 18;
+
+template<class Book>
+void runWorkload(benchmark::State& state, const WorkloadConfig& config)
+{
+    auto commands = generateWorkload(config, workloadLength);
+    auto book = std::make_unique<Book>();
+    std::size_t next = 0;
+    std::size_t trades = 0;
+
+    for (auto _ : state)
+    {
+        if (next == commands.size())
+        {
+            state.PauseTiming();
+            book = std::make_unique<Book>();
+            next = 0;
+            state.ResumeTiming();
+        }
+
+        commands[next++].applyTo(*book, [&](const Trade&) { ++trades; });
+    }
+
+    state.counters["trades_per_op"] =
+        benchmark::Counter(static_cast<double>(trades), benchmark::Counter::kAvgIterations);
+}
+
+// Most orders are cancelled close to the touch, so queues are long and
+// cancels dominate
+template<class Book>
+void BM_CancelHeavy(benchmark::State& state)
+{
+    WorkloadConfig config;
+    config.addShare_ = 0.40;
+    config.cancelShare_ = 0.55;
+    config.modifyShare_ = 0.03;
+    config.marketShare_ = 0.02;
+    config.crossShare_ = 0.02;
+    config.meanLevelOffset_ = 2.0;
+    runWorkload<Book>(state, config);
+}
+
+// A deep passive book swept by large market orders
+template<class Book>
+void BM_DeepSweep(benchmark::State& state)
+{
+    WorkloadConfig config;
+    config.addShare_ = 0.80;
+    config.cancelShare_ = 0.10;
+    config.modifyShare_ = 0.0;
+    config.marketShare_ = 0.10;
+    config.crossShare_ = 0.0;
+    config.meanLevelOffset_ = 8.0;
+    config.marketSizeScale_ = 200.0;
+    runWorkload<Book>(state, config);
+}
+
+// Orders spread thinly over hundreds of levels spaced five ticks apart
+template<class Book>
+void BM_WideSparse(benchmark::State& state)
+{
+    WorkloadConfig config;
+    config.addShare_ = 0.55;
+    config.cancelShare_ = 0.40;
+    config.modifyShare_ = 0.0;
+    config.marketShare_ = 0.05;
+    config.meanLevelOffset_ = 64.0;
+    config.levelSpacing_ = 5;
+    config.midMoveShare_ = 0.05;
+    runWorkload<Book>(state, config);
+}
+
+// A third of resting orders are AllOrNone and a tenth of adds FillOrKill,
+// with frequent crossing so fill checks run against them
+template<class Book>
+void BM_HighAllOrNone(benchmark::State& state)
+{
+    WorkloadConfig config;
+    config.addShare_ = 0.60;
+    config.cancelShare_ = 0.30;
+    config.modifyShare_ = 0.0;
+    config.marketShare_ = 0.10;
+    config.allOrNoneShare_ = 0.30;
+    config.fillOrKillShare_ = 0.10;
+    config.crossShare_ = 0.20;
+    runWorkload<Book>(state, config);
+}
+
+// The default mixed flow on a book timing every call with the TSC, reporting
+// percentiles in ticks. Against the same book without a recorder this gives
+// the cost of instrumentation
+template<class Book>
+void BM_WorkloadLatency(benchmark::State& state)
+{
+    auto commands = generateWorkload(WorkloadConfig{}, workloadLength);
+    auto book = std::make_unique<Book>();
+    std::size_t next = 0;
+    LatencySnapshot latency;
+
+    for (auto _ : state)
+    {
+        if (next == commands.size())
+        {
+            state.PauseTiming();
+            if constexpr (!std::is_same_v<decltype(book->latencyRecorder()), NullLatencyRecorder&>)
+            {
+                latency.merge(book->latencyRecorder().snapshot());
+            }
+            book = std::make_unique<Book>();
+            next = 0;
+            state.ResumeTiming();
+        }
+
+        commands[next++].applyTo(*book, [](const Trade&) {});
+    }
+
+    if constexpr (!std::is_same_v<decltype(book->latencyRecorder()), NullLatencyRecorder&>)
+    {
+        latency.merge(book->latencyRecorder().snapshot());
+
+        for (auto [name, operation] : {std::pair{"add", BookOperation::Add},
+                                       std::pair{"cancel", BookOperation::Cancel},
+                                       std::pair{"modify", BookOperation::Modify}})
+        {
+            auto histogram = latency.histogram(operation);
+            state.counters[std::string{name} + "_p50"] = static_cast<double>(histogram.percentile(0.5));
+            state.counters[std::string{name} + "_p99"] = static_cast<double>(histogram.percentile(0.99));
+            state.counters[std::string{name} + "_p999"] = static_cast<double>(histogram.percentile(0.999));
+        }
+    }
+}
+
+using UntimedBook = OrderBook<ArrayLevelPolicy, IntrusiveOrderPolicy, PoolOrderAllocator, FlatOrderIndex>;
+using TimedBook = OrderBook<ArrayLevelPolicy, IntrusiveOrderPolicy, PoolOrderAllocator, FlatOrderIndex,
+                            NullDepthListener, NullOrderEventListener, NullJournal, TscLatencyRecorder>;
+
+BENCHMARK_TEMPLATE(BM_WorkloadLatency, UntimedBook);
+BENCHMARK_TEMPLATE(BM_WorkloadLatency, TimedBook);
+
+BENCHMARK_TEMPLATE(BM_CancelHeavy, OrderBook<MapLevelPolicy, DequeOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_CancelHeavy, OrderBook<MapLevelPolicy, ListOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_CancelHeavy, OrderBook<MapLevelPolicy, VectorOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_CancelHeavy, OrderBook<MapLevelPolicy, IntrusiveOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_CancelHeavy, OrderBook<VectorLevelPolicy, DequeOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_CancelHeavy, OrderBook<VectorLevelPolicy, ListOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_CancelHeavy, OrderBook<VectorLevelPolicy, VectorOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_CancelHeavy, OrderBook<VectorLevelPolicy, IntrusiveOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_CancelHeavy, OrderBook<ListLevelPolicy, DequeOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_CancelHeavy, OrderBook<ListLevelPolicy, ListOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_CancelHeavy, OrderBook<ListLevelPolicy, VectorOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_CancelHeavy, OrderBook<ListLevelPolicy, IntrusiveOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_CancelHeavy, OrderBook<ArrayLevelPolicy, DequeOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_CancelHeavy, OrderBook<ArrayLevelPolicy, ListOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_CancelHeavy, OrderBook<ArrayLevelPolicy, VectorOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_CancelHeavy, OrderBook<ArrayLevelPolicy, IntrusiveOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_CancelHeavy, OrderBook<MapLevelPolicy, ColumnarOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_CancelHeavy, OrderBook<VectorLevelPolicy, ColumnarOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_CancelHeavy, OrderBook<ListLevelPolicy, ColumnarOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_CancelHeavy, OrderBook<ArrayLevelPolicy, ColumnarOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_CancelHeavy, OrderBook<MapLevelPolicy, TombstoneDequeOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_CancelHeavy, OrderBook<MapLevelPolicy, TombstoneVectorOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_CancelHeavy, OrderBook<ArrayLevelPolicy, TombstoneDequeOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_CancelHeavy, OrderBook<ArrayLevelPolicy, TombstoneVectorOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_CancelHeavy, OrderBook<ChunkedLevelPolicy, DequeOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_CancelHeavy, OrderBook<ChunkedLevelPolicy, IntrusiveOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_CancelHeavy, OrderBook<ChunkedLevelPolicy, ColumnarOrderPolicy>);
+
+BENCHMARK_TEMPLATE(BM_DeepSweep, OrderBook<MapLevelPolicy, DequeOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_DeepSweep, OrderBook<MapLevelPolicy, ListOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_DeepSweep, OrderBook<MapLevelPolicy, VectorOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_DeepSweep, OrderBook<MapLevelPolicy, IntrusiveOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_DeepSweep, OrderBook<VectorLevelPolicy, DequeOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_DeepSweep, OrderBook<VectorLevelPolicy, ListOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_DeepSweep, OrderBook<VectorLevelPolicy, VectorOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_DeepSweep, OrderBook<VectorLevelPolicy, IntrusiveOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_DeepSweep, OrderBook<ListLevelPolicy, DequeOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_DeepSweep, OrderBook<ListLevelPolicy, ListOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_DeepSweep, OrderBook<ListLevelPolicy, VectorOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_DeepSweep, OrderBook<ListLevelPolicy, IntrusiveOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_DeepSweep, OrderBook<ArrayLevelPolicy, DequeOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_DeepSweep, OrderBook<ArrayLevelPolicy, ListOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_DeepSweep, OrderBook<ArrayLevelPolicy, VectorOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_DeepSweep, OrderBook<ArrayLevelPolicy, IntrusiveOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_DeepSweep, OrderBook<MapLevelPolicy, ColumnarOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_DeepSweep, OrderBook<VectorLevelPolicy, ColumnarOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_DeepSweep, OrderBook<ListLevelPolicy, ColumnarOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_DeepSweep, OrderBook<ArrayLevelPolicy, ColumnarOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_DeepSweep, OrderBook<MapLevelPolicy, TombstoneDequeOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_DeepSweep, OrderBook<MapLevelPolicy, TombstoneVectorOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_DeepSweep, OrderBook<ChunkedLevelPolicy, DequeOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_DeepSweep, OrderBook<ChunkedLevelPolicy, IntrusiveOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_DeepSweep, OrderBook<ChunkedLevelPolicy, ColumnarOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_DeepSweep, OrderBook<ArrayLevelPolicy, TombstoneDequeOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_DeepSweep, OrderBook<ArrayLevelPolicy, TombstoneVectorOrderPolicy>);
+
+BENCHMARK_TEMPLATE(BM_WideSparse, OrderBook<MapLevelPolicy, DequeOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_WideSparse, OrderBook<MapLevelPolicy, ListOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_WideSparse, OrderBook<MapLevelPolicy, VectorOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_WideSparse, OrderBook<MapLevelPolicy, IntrusiveOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_WideSparse, OrderBook<VectorLevelPolicy, DequeOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_WideSparse, OrderBook<VectorLevelPolicy, ListOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_WideSparse, OrderBook<VectorLevelPolicy, VectorOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_WideSparse, OrderBook<VectorLevelPolicy, IntrusiveOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_WideSparse, OrderBook<ListLevelPolicy, DequeOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_WideSparse, OrderBook<ListLevelPolicy, ListOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_WideSparse, OrderBook<ListLevelPolicy, VectorOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_WideSparse, OrderBook<ListLevelPolicy, IntrusiveOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_WideSparse, OrderBook<ArrayLevelPolicy, DequeOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_WideSparse, OrderBook<ArrayLevelPolicy, ListOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_WideSparse, OrderBook<ArrayLevelPolicy, VectorOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_WideSparse, OrderBook<ArrayLevelPolicy, IntrusiveOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_WideSparse, OrderBook<MapLevelPolicy, ColumnarOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_WideSparse, OrderBook<VectorLevelPolicy, ColumnarOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_WideSparse, OrderBook<ListLevelPolicy, ColumnarOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_WideSparse, OrderBook<ArrayLevelPolicy, ColumnarOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_WideSparse, OrderBook<MapLevelPolicy, TombstoneDequeOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_WideSparse, OrderBook<MapLevelPolicy, TombstoneVectorOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_WideSparse, OrderBook<ArrayLevelPolicy, TombstoneDequeOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_WideSparse, OrderBook<ArrayLevelPolicy, TombstoneVectorOrderPolicy>);
+
+BENCHMARK_TEMPLATE(BM_HighAllOrNone, OrderBook<MapLevelPolicy, DequeOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_HighAllOrNone, OrderBook<MapLevelPolicy, ListOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_HighAllOrNone, OrderBook<MapLevelPolicy, VectorOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_HighAllOrNone, OrderBook<MapLevelPolicy, IntrusiveOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_HighAllOrNone, OrderBook<VectorLevelPolicy, DequeOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_HighAllOrNone, OrderBook<VectorLevelPolicy, ListOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_HighAllOrNone, OrderBook<VectorLevelPolicy, VectorOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_HighAllOrNone, OrderBook<VectorLevelPolicy, IntrusiveOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_HighAllOrNone, OrderBook<ListLevelPolicy, DequeOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_HighAllOrNone, OrderBook<ListLevelPolicy, ListOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_HighAllOrNone, OrderBook<ListLevelPolicy, VectorOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_HighAllOrNone, OrderBook<ListLevelPolicy, IntrusiveOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_HighAllOrNone, OrderBook<ArrayLevelPolicy, DequeOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_HighAllOrNone, OrderBook<ArrayLevelPolicy, ListOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_HighAllOrNone, OrderBook<ArrayLevelPolicy, VectorOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_HighAllOrNone, OrderBook<ArrayLevelPolicy, IntrusiveOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_HighAllOrNone, OrderBook<MapLevelPolicy, ColumnarOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_HighAllOrNone, OrderBook<VectorLevelPolicy, ColumnarOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_HighAllOrNone, OrderBook<ListLevelPolicy, ColumnarOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_HighAllOrNone, OrderBook<ArrayLevelPolicy, ColumnarOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_HighAllOrNone, OrderBook<MapLevelPolicy, TombstoneDequeOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_HighAllOrNone, OrderBook<MapLevelPolicy, TombstoneVectorOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_HighAllOrNone, OrderBook<ArrayLevelPolicy, TombstoneDequeOrderPolicy>);
+BENCHMARK_TEMPLATE(BM_HighAllOrNone, OrderBook<ArrayLevelPolicy, TombstoneVectorOrderPolicy>);
+
 BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_AddOrder, OrderBook<MapLevelPolicy, DequeOrderPolicy>);
 BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_AddOrder, OrderBook<MapLevelPolicy, ListOrderPolicy>);
 BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_AddOrder, OrderBook<MapLevelPolicy, VectorOrderPolicy>);
+BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_AddOrder, OrderBook<MapLevelPolicy, IntrusiveOrderPolicy>);
 BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_AddOrder, OrderBook<VectorLevelPolicy, DequeOrderPolicy>);
 BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_AddOrder, OrderBook<VectorLevelPolicy, ListOrderPolicy>);
 BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_AddOrder, OrderBook<VectorLevelPolicy, VectorOrderPolicy>);
+BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_AddOrder, OrderBook<VectorLevelPolicy, IntrusiveOrderPolicy>);
 BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_AddOrder, OrderBook<ListLevelPolicy, DequeOrderPolicy>);
 BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_AddOrder, OrderBook<ListLevelPolicy, ListOrderPolicy>);
 BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_AddOrder, OrderBook<ListLevelPolicy, VectorOrderPolicy>);
+BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_AddOrder, OrderBook<ListLevelPolicy, IntrusiveOrderPolicy>);
+BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_AddOrder, OrderBook<ArrayLevelPolicy, VectorOrderPolicy>);
+BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_AddOrder, OrderBook<ArrayLevelPolicy, IntrusiveOrderPolicy>);
+BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_AddOrder, OrderBook<ChunkedLevelPolicy, VectorOrderPolicy>);
+BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_AddOrder, OrderBook<ChunkedLevelPolicy, IntrusiveOrderPolicy>);
+
+BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_AddCancel, OrderBook<MapLevelPolicy, DequeOrderPolicy>);
+BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_AddCancel, OrderBook<MapLevelPolicy, ListOrderPolicy>);
+BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_AddCancel, OrderBook<MapLevelPolicy, VectorOrderPolicy>);
+BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_AddCancel, OrderBook<MapLevelPolicy, IntrusiveOrderPolicy>);
+BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_AddCancel, OrderBook<MapLevelPolicy, VectorOrderPolicy, PoolOrderAllocator>);
+BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_AddCancel, OrderBook<MapLevelPolicy, IntrusiveOrderPolicy, PoolOrderAllocator>);
+BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_AddCancel, OrderBook<VectorLevelPolicy, VectorOrderPolicy, PoolOrderAllocator>);
+BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_AddCancel, OrderBook<VectorLevelPolicy, IntrusiveOrderPolicy, PoolOrderAllocator>);
+BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_AddCancel, OrderBook<ListLevelPolicy, IntrusiveOrderPolicy, PoolOrderAllocator>);
+BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_AddCancel, OrderBook<ArrayLevelPolicy, IntrusiveOrderPolicy, PoolOrderAllocator>);
+BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_AddCancel, OrderBook<ChunkedLevelPolicy, IntrusiveOrderPolicy, PoolOrderAllocator>);
+BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_AddCancel, OrderBook<MapLevelPolicy, IntrusiveOrderPolicy, PoolOrderAllocator, FlatOrderIndex>);
+BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_AddCancel, OrderBook<ArrayLevelPolicy, IntrusiveOrderPolicy, PoolOrderAllocator, FlatOrderIndex>);
+
+BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_CancelDeepQueue, OrderBook<ArrayLevelPolicy, DequeOrderPolicy>)->Arg(64)->Arg(4096);
+BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_CancelDeepQueue, OrderBook<ArrayLevelPolicy, VectorOrderPolicy>)->Arg(64)->Arg(4096);
+BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_CancelDeepQueue, OrderBook<ArrayLevelPolicy, TombstoneDequeOrderPolicy>)->Arg(64)->Arg(4096);
+BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_CancelDeepQueue, OrderBook<ArrayLevelPolicy, TombstoneVectorOrderPolicy>)->Arg(64)->Arg(4096);
+BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_CancelDeepQueue, OrderBook<ArrayLevelPolicy, IntrusiveOrderPolicy>)->Arg(64)->Arg(4096);
+
+BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_CancelAcrossLevels, OrderBook<MapLevelPolicy, IntrusiveOrderPolicy, PoolOrderAllocator, FlatOrderIndex>)->Arg(16)->Arg(1024);
+BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_CancelAcrossLevels, OrderBook<VectorLevelPolicy, IntrusiveOrderPolicy, PoolOrderAllocator, FlatOrderIndex>)->Arg(16)->Arg(1024);
+BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_CancelAcrossLevels, OrderBook<ListLevelPolicy, IntrusiveOrderPolicy, PoolOrderAllocator, FlatOrderIndex>)->Arg(16)->Arg(1024);
+BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_CancelAcrossLevels, OrderBook<ListLevelPolicy, ListOrderPolicy, PoolOrderAllocator, FlatOrderIndex>)->Arg(16)->Arg(1024);
+BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_CancelAcrossLevels, OrderBook<ArrayLevelPolicy, IntrusiveOrderPolicy, PoolOrderAllocator, FlatOrderIndex>)->Arg(16)->Arg(1024);
+BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_CancelAcrossLevels, OrderBook<ChunkedLevelPolicy, IntrusiveOrderPolicy, PoolOrderAllocator, FlatOrderIndex>)->Arg(16)->Arg(1024);
+
+BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_LevelChurn, OrderBook<MapLevelPolicy, IntrusiveOrderPolicy, PoolOrderAllocator, FlatOrderIndex>)->Arg(64)->Arg(4096);
+BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_LevelChurn, OrderBook<VectorLevelPolicy, IntrusiveOrderPolicy, PoolOrderAllocator, FlatOrderIndex>)->Arg(64)->Arg(4096);
+BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_LevelChurn, OrderBook<ListLevelPolicy, IntrusiveOrderPolicy, PoolOrderAllocator, FlatOrderIndex>)->Arg(64)->Arg(4096);
+BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_LevelChurn, OrderBook<ArrayLevelPolicy, IntrusiveOrderPolicy, PoolOrderAllocator, FlatOrderIndex>)->Arg(64)->Arg(4096);
+BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_LevelChurn, OrderBook<ChunkedLevelPolicy, IntrusiveOrderPolicy, PoolOrderAllocator, FlatOrderIndex>)->Arg(64)->Arg(4096);
+
+BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_PriceDrift, OrderBook<MapLevelPolicy, DequeOrderPolicy, PoolOrderAllocator, FlatOrderIndex>)->Arg(64)->Arg(512);
+BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_PriceDrift, OrderBook<ArrayLevelPolicy, DequeOrderPolicy, PoolOrderAllocator, FlatOrderIndex>)->Arg(64)->Arg(512);
+BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_PriceDrift, OrderBook<ArrayLevelPolicy, IntrusiveOrderPolicy, PoolOrderAllocator, FlatOrderIndex>)->Arg(64)->Arg(512);
+BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_PriceDrift, OrderBook<ChunkedLevelPolicy, DequeOrderPolicy, PoolOrderAllocator, FlatOrderIndex>)->Arg(64)->Arg(512);
+
+BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_AmendDown, OrderBook<MapLevelPolicy, VectorOrderPolicy>);
+BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_AmendDown, OrderBook<VectorLevelPolicy, ListOrderPolicy>);
+BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_AmendDown, OrderBook<ArrayLevelPolicy, IntrusiveOrderPolicy, PoolOrderAllocator, FlatOrderIndex>);
+BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_Reprice, OrderBook<MapLevelPolicy, VectorOrderPolicy>);
+BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_Reprice, OrderBook<VectorLevelPolicy, ListOrderPolicy>);
+BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_Reprice, OrderBook<ArrayLevelPolicy, IntrusiveOrderPolicy, PoolOrderAllocator, FlatOrderIndex>);
+
+BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_SparseFillCheck, OrderBook<MapLevelPolicy, IntrusiveOrderPolicy>)->Arg(1)->Arg(64)->Arg(4096);
+BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_SparseFillCheck, OrderBook<ArrayLevelPolicy, IntrusiveOrderPolicy>)->Arg(1)->Arg(64)->Arg(4096);
+BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_DeepFillCheck, OrderBook<MapLevelPolicy, IntrusiveOrderPolicy>)->Arg(5120)->Arg(10241);
+BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_DeepFillCheck, OrderBook<VectorLevelPolicy, VectorOrderPolicy>)->Arg(5120)->Arg(10241);
+BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_DeepFillCheck, OrderBook<ArrayLevelPolicy, IntrusiveOrderPolicy>)->Arg(5120)->Arg(10241);
+BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_DeepFillCheck, OrderBook<ChunkedLevelPolicy, IntrusiveOrderPolicy>)->Arg(5120)->Arg(10241);
+BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_FillCheckSweep, OrderBook<ArrayLevelPolicy, DequeOrderPolicy>)->DenseRange(1, 50, 7);
+BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_FillCheckSweep, OrderBook<ArrayLevelPolicy, IntrusiveOrderPolicy>)->DenseRange(1, 50, 7);
+BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_FillCheckSweep, OrderBook<ArrayLevelPolicy, ColumnarOrderPolicy>)->DenseRange(1, 50, 7);
+BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_QueuedAllOrNoneFillCheck, OrderBook<ArrayLevelPolicy, DequeOrderPolicy>)->Arg(64)->Arg(4096);
+BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_QueuedAllOrNoneFillCheck, OrderBook<ArrayLevelPolicy, IntrusiveOrderPolicy>)->Arg(64)->Arg(4096);
+BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_QueuedAllOrNoneFillCheck, OrderBook<ArrayLevelPolicy, ColumnarOrderPolicy>)->Arg(64)->Arg(4096);
+BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_AllOrNoneDepthMatch, OrderBook<ArrayLevelPolicy, IntrusiveOrderPolicy, PoolOrderAllocator, FlatOrderIndex>)->Arg(8)->Arg(4096);
+BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_AllOrNoneDepthCancel, OrderBook<ArrayLevelPolicy, IntrusiveOrderPolicy, PoolOrderAllocator, FlatOrderIndex>)->Arg(8)->Arg(4096);
+BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_SparseSweep, OrderBook<MapLevelPolicy, IntrusiveOrderPolicy>)->Arg(1)->Arg(64)->Arg(4096);
+BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_SparseSweep, OrderBook<ArrayLevelPolicy, IntrusiveOrderPolicy>)->Arg(1)->Arg(64)->Arg(4096);
+
+BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_AddCancelDepth, OrderBook<ArrayLevelPolicy, IntrusiveOrderPolicy, PoolOrderAllocator, FlatOrderIndex, DepthFeed>);
+BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_AddCancelDepth, OrderBook<ArrayLevelPolicy, IntrusiveOrderPolicy, PoolOrderAllocator, FlatOrderIndex, ConflatedDepthFeed>);
+
+BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_CrossTrades, OrderBook<MapLevelPolicy, IntrusiveOrderPolicy, PoolOrderAllocator>);
+BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_CrossTrades, OrderBook<ArrayLevelPolicy, IntrusiveOrderPolicy, PoolOrderAllocator>);
+BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_CrossSink, OrderBook<MapLevelPolicy, IntrusiveOrderPolicy, PoolOrderAllocator>);
+BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_CrossSink, OrderBook<ArrayLevelPolicy, IntrusiveOrderPolicy, PoolOrderAllocator>);
+BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_CrossSink, OrderBook<ArrayLevelPolicy, IntrusiveOrderPolicy, PoolOrderAllocator, FlatOrderIndex>);
+BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_CrossSink, OrderBook<ArrayLevelPolicy, IntrusiveOrderPolicy, PoolOrderAllocator, FlatOrderIndex, NullDepthListener, NullOrderEventListener, NullJournal, NullLatencyRecorder, false>);
+BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_CrossTyped, OrderBook<ArrayLevelPolicy, IntrusiveOrderPolicy, PoolOrderAllocator, FlatOrderIndex>);
+BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_CrossTyped, OrderBook<ArrayLevelPolicy, IntrusiveOrderPolicy, PoolOrderAllocator, FlatOrderIndex, NullDepthListener, NullOrderEventListener, NullJournal, NullLatencyRecorder, false>);
+BENCHMARK_TEMPLATE_INSTANTIATE_F(OrderBookFixture, BM_CrossEvents, OrderBook<ArrayLevelPolicy, IntrusiveOrderPolicy, PoolOrderAllocator, FlatOrderIndex, NullDepthListener, OrderEventBuffer>);
 
 BENCHMARK_MAIN();
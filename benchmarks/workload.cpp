@@ -0,0 +1,142 @@
+#include "workload.h"
+
+#include <random>
+
+// What the generator last asked for on an order it has not cancelled
+struct LiveOrder
+{
+    OrderId id_;
+    OrderType type_;
+    Side side_;
+    Price price_;
+    Size size_;
+};
+
+std::vector<Command> generateWorkload(const WorkloadConfig& config, std::size_t count)
+{
+    std::mt19937_64 rng{config.seed_};
+
+    std::discrete_distribution<int> action{
+        config.addShare_, config.cancelShare_, config.modifyShare_, config.marketShare_
+    };
+    std::uniform_real_distribution<double> unit{0.0, 1.0};
+    std::geometric_distribution<Price> levelOffset{1.0 / (1.0 + config.meanLevelOffset_)};
+    std::geometric_distribution<Size> size{1.0 / config.meanSize_};
+    std::uniform_int_distribution<Price> repriceLevels{1, config.maxRepriceLevels_};
+
+    Price mid = config.startMid_;
+    OrderId nextId = 0;
+    std::vector<LiveOrder> live;
+    std::vector<Command> commands;
+    commands.reserve(count);
+
+    auto limitPrice = [&](Side side)
+    {
+        Price offset = (1 + levelOffset(rng)) * config.levelSpacing_;
+        if (unit(rng) < config.crossShare_)
+        {
+            offset = -offset;
+        }
+        return side == Side::Buy ? mid - offset : mid + offset;
+    };
+
+    auto limitType = [&]
+    {
+        double draw = unit(rng);
+        if (draw < config.allOrNoneShare_)
+        {
+            return OrderType::AllOrNone;
+        }
+        if (draw < config.allOrNoneShare_ + config.fillOrKillShare_)
+        {
+            return OrderType::FillOrKill;
+        }
+        return OrderType::GoodTillCancel;
+    };
+
+    // Picks a live order and forgets it, swapping the last one into its slot
+    auto takeLive = [&]
+    {
+        std::uniform_int_distribution<std::size_t> pick{0, live.size() - 1};
+        auto i = pick(rng);
+        LiveOrder order = live[i];
+        live[i] = live.back();
+        live.pop_back();
+        return order;
+    };
+
+    while (commands.size() < count)
+    {
+        if (unit(rng) < config.midMoveShare_)
+        {
+            mid += unit(rng) < 0.5 ? -config.levelSpacing_ : config.levelSpacing_;
+        }
+
+        Side side = unit(rng) < 0.5 ? Side::Buy : Side::Sell;
+        int kind = action(rng);
+
+        // Nothing to cancel or modify yet, so add instead
+        if ((kind == 1 || kind == 2) && live.empty())
+        {
+            kind = 0;
+        }
+
+        switch (kind)
+        {
+        case 0:
+        {
+            auto type = limitType();
+            auto price = limitPrice(side);
+            auto volume = 1 + size(rng);
+            commands.push_back(Command{
+                CommandType::Add, type, side, SymbolId{}, nextId, price, volume
+            });
+            if (type != OrderType::FillOrKill)
+            {
+                live.push_back(LiveOrder{nextId, type, side, price, volume});
+            }
+            ++nextId;
+            break;
+        }
+        case 1:
+            commands.push_back(Command{
+                CommandType::Cancel, OrderType::GoodTillCancel, side, SymbolId{}, takeLive().id_,
+                0, 0
+            });
+            break;
+        case 2:
+        {
+            // Keep the order's type and side: mostly take size off in place,
+            // otherwise move it a few levels either way
+            LiveOrder order = takeLive();
+            if (order.size_ > 1 && unit(rng) < config.modifyReduceShare_)
+            {
+                std::uniform_int_distribution<Size> smaller{1, order.size_ - 1};
+                order.size_ = smaller(rng);
+            }
+            else
+            {
+                Price step = repriceLevels(rng) * config.levelSpacing_;
+                order.price_ += unit(rng) < 0.5 ? -step : step;
+            }
+            commands.push_back(Command{
+                CommandType::Modify, order.type_, order.side_, SymbolId{}, order.id_, order.price_,
+                order.size_
+            });
+            live.push_back(order);
+            break;
+        }
+        default:
+        {
+            auto volume = static_cast<double>(1 + size(rng)) * config.marketSizeScale_;
+            commands.push_back(Command{
+                CommandType::Add, OrderType::Market, side, SymbolId{}, nextId++, MARKET_PRICE,
+                static_cast<Size>(volume)
+            });
+            break;
+        }
+        }
+    }
+
+    return commands;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "orderbook/command.h"
+#include "orderbook/types.h"
+
+// Shape of a synthetic order flow. The action shares are relative weights;
+// the order type shares are probabilities applied to each limit add
+struct WorkloadConfig
+{
+    std::uint64_t seed_ = 42;
+
+    double addShare_ = 0.55;
+    double cancelShare_ = 0.35;
+    double modifyShare_ = 0.05;
+    double marketShare_ = 0.05;
+
+    double allOrNoneShare_ = 0.0;
+    double fillOrKillShare_ = 0.0;
+
+    // Share of limit adds priced through the mid so they trade on arrival
+    double crossShare_ = 0.05;
+
+    // Passive prices sit a geometrically distributed number of levels
+    // behind the mid, every levelSpacing_ ticks
+    Price startMid_ = 100000;
+    double meanLevelOffset_ = 4.0;
+    Price levelSpacing_ = 1;
+
+    // Chance per command that the mid steps one level up or down
+    double midMoveShare_ = 0.01;
+
+    // Modifies keep the order's type and side. This share takes size off
+    // at the same price, which the book amends in place; the rest reprice
+    // by up to maxRepriceLevels_ levels either way
+    double modifyReduceShare_ = 0.7;
+    Price maxRepriceLevels_ = 3;
+
+    // Limit sizes are 1 + geometric with this mean, market sizes are scaled
+    double meanSize_ = 10.0;
+    double marketSizeScale_ = 1.0;
+};
+
+// Generates a reproducible command stream for one symbol. Cancels and
+// modifies target orders the generator has added and not yet cancelled;
+// some of those will have filled, which the book treats as a no-op
+std::vector<Command> generateWorkload(const WorkloadConfig& config, std::size_t count);
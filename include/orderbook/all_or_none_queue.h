@@ -0,0 +1,215 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "orderbook/order.h"
+#include "orderbook/types.h"
+
+/**
+ * @brief A level's AllOrNone orders in arrival order, searchable by size
+ *
+ * @details Entries sit in slots in the order they arrived. A tree holding
+ *          the smallest size under each node finds the first entry at or
+ *          after a slot that fits a given volume in O(log k), so a match
+ *          or fill check passes over orders too large to fill without
+ *          looking at them. Each order keeps its slot in Order::slot_,
+ *          which AllOrNone orders do not otherwise use, so erase and reduce
+ *          are O(log k). Erased entries are left as tombstones sized so no
+ *          volume fits them, and are compacted away by the next push once
+ *          they outnumber the live entries.
+ */
+class AllOrNoneQueue
+{
+public:
+  AllOrNoneQueue()
+      : orders_{}, sequences_{}, sizes_{}, leaves_{}, live_{}
+  {
+  }
+
+  std::size_t size() const { return live_; }
+  bool empty() const { return live_ == 0; }
+
+  /**
+   * @brief Slots [0, lastSlot()) hold every entry, tombstones included
+   */
+  std::size_t lastSlot() const { return orders_.size(); }
+
+  OrderPointer order(std::size_t slot) const { return orders_[slot]; }
+  std::uint32_t sequence(std::size_t slot) const { return sequences_[slot]; }
+  Size size(std::size_t slot) const { return sizes_[leaves_ + slot]; }
+
+  /**
+   * @brief Appends order, needing its remaining size filled at once
+   */
+  void push(OrderPointer order)
+  {
+    if (live_ == 0)
+    {
+      clear();
+    }
+    else if (orders_.size() - live_ > live_)
+    {
+      compact();
+    }
+
+    if (orders_.size() == leaves_)
+    {
+      rebuild(std::max<std::size_t>(minLeaves_, 2 * leaves_));
+    }
+
+    order->slot_ = static_cast<std::uint32_t>(orders_.size());
+    orders_.push_back(order);
+    sequences_.push_back(order->sequence_);
+    set(order->slot_, order->getRemainingSize());
+    ++live_;
+  }
+
+  void erase(OrderPointer order)
+  {
+    orders_[order->slot_] = nullptr;
+    set(order->slot_, tombstone_);
+    --live_;
+  }
+
+  /**
+   * @brief Takes size off order's entry without moving it
+   */
+  void reduce(OrderPointer order, Size size)
+  {
+    set(order->slot_, this->size(order->slot_) - size);
+  }
+
+  /**
+   * @brief First live slot at or after from whose size is at most limit,
+   *        or lastSlot() when there is none
+   */
+  std::size_t find(Size limit, std::size_t from = 0) const
+  {
+    if (from >= orders_.size())
+      return orders_.size();
+
+    limit = std::min(limit, tombstone_ - 1);
+
+    // Climb to the first subtree at or after from holding a fit
+    auto node = leaves_ + from;
+    while (sizes_[node] > limit)
+    {
+      while (node & 1)
+      {
+        node >>= 1;
+      }
+      if (node == 0)
+        return orders_.size();
+      ++node;
+    }
+
+    // Then descend to its leftmost fit
+    while (node < leaves_)
+    {
+      node *= 2;
+      if (sizes_[node] > limit)
+      {
+        ++node;
+      }
+    }
+    return std::min(node - leaves_, orders_.size());
+  }
+
+  /**
+   * @brief First live slot at or after from, or lastSlot()
+   */
+  std::size_t next(std::size_t from) const { return find(tombstone_, from); }
+
+private:
+  // Size of a tombstone or unused slot, more than any volume can fill
+  static constexpr Size tombstone_ = ~Size{};
+  static constexpr std::size_t minLeaves_ = 8;
+
+  /**
+   * @brief Drops every entry once all are tombstones, which leaves the
+   *        tree as it would be empty
+   */
+  void clear()
+  {
+    orders_.clear();
+    sequences_.clear();
+  }
+
+  /**
+   * @brief Sets slot's size and the smallest size above it up to the root
+   */
+  void set(std::size_t slot, Size size)
+  {
+    auto node = leaves_ + slot;
+    sizes_[node] = size;
+    for (node >>= 1; node > 0; node >>= 1)
+    {
+      sizes_[node] = std::min(sizes_[2 * node], sizes_[2 * node + 1]);
+    }
+  }
+
+  /**
+   * @brief Moves the live entries to the front, renumbering their slots
+   */
+  void compact()
+  {
+    std::size_t to = 0;
+    for (std::size_t from = 0; from < orders_.size(); ++from)
+    {
+      if (!orders_[from])
+        continue;
+
+      sizes_[leaves_ + to] = sizes_[leaves_ + from];
+      orders_[to] = orders_[from];
+      sequences_[to] = sequences_[from];
+      orders_[to]->slot_ = static_cast<std::uint32_t>(to);
+      ++to;
+    }
+
+    std::fill(sizes_.begin() + leaves_ + to,
+              sizes_.begin() + leaves_ + orders_.size(), tombstone_);
+    orders_.resize(to);
+    sequences_.resize(to);
+    pull(sizes_, leaves_);
+  }
+
+  /**
+   * @brief Lays the tree out over leaves slots, keeping the entries' sizes
+   */
+  void rebuild(std::size_t leaves)
+  {
+    std::vector<Size> sizes(2 * leaves, tombstone_);
+    for (std::size_t slot = 0; slot < orders_.size(); ++slot)
+    {
+      sizes[leaves + slot] = size(slot);
+    }
+    pull(sizes, leaves);
+
+    sizes_ = std::move(sizes);
+    leaves_ = leaves;
+  }
+
+  /**
+   * @brief Recomputes every node above the leaves from its children
+   */
+  static void pull(std::vector<Size> &sizes, std::size_t leaves)
+  {
+    for (auto node = leaves - 1; node > 0; --node)
+    {
+      sizes[node] = std::min(sizes[2 * node], sizes[2 * node + 1]);
+    }
+  }
+
+  std::vector<OrderPointer> orders_;
+  std::vector<std::uint32_t> sequences_;
+
+  // Min-tree over the slots' sizes: leaves from leaves_, node n's children
+  // at 2n and 2n + 1
+  std::vector<Size> sizes_;
+  std::size_t leaves_;
+  std::size_t live_;
+};
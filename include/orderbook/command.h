@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+
+#include "orderbook/types.h"
+
+enum class CommandType : std::uint8_t
+{
+  Add,
+  Cancel,
+  Modify,
+};
+
+/**
+ * @brief Fixed-size order entry record queued between threads
+ *
+ * @details Cancel only reads symbol_ and orderId_.
+ */
+struct Command
+{
+  CommandType type_;
+  OrderType orderType_;
+  Side side_;
+  SymbolId symbol_;
+  OrderId orderId_;
+  Price price_;
+  Size volume_;
+
+  /**
+   * @brief Applies this command to book, passing executions to onTrade
+   */
+  template <typename Book> void applyTo(Book &book, auto &&onTrade) const
+  {
+    switch (type_)
+    {
+    case CommandType::Add:
+      book.addOrder(orderType_, orderId_, side_, price_, volume_, onTrade);
+      break;
+    case CommandType::Cancel:
+      book.cancelOrder(orderId_);
+      break;
+    case CommandType::Modify:
+      book.modifyOrder(orderType_, orderId_, side_, price_, volume_, onTrade);
+      break;
+    }
+  }
+};
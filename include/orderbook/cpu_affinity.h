@@ -0,0 +1,28 @@
+#pragma once
+
+#include <thread>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+/**
+ * @brief Restricts thread to run on core
+ *
+ * @return false if the platform does not support pinning or refused it
+ */
+inline bool pinToCore(std::jthread &thread, int core)
+{
+#ifdef __linux__
+  cpu_set_t cpus;
+  CPU_ZERO(&cpus);
+  CPU_SET(core, &cpus);
+  return pthread_setaffinity_np(thread.native_handle(), sizeof(cpus),
+                                &cpus) == 0;
+#else
+  (void)thread;
+  (void)core;
+  return false;
+#endif
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+#include "orderbook/order_index.h"
+#include "orderbook/types.h"
+
+/**
+ * @brief New aggregate volume resting at one price level
+ *
+ * @details A size_ of zero means the level was removed.
+ */
+struct DepthUpdate
+{
+  Side side_;
+  Price price_;
+  Size size_;
+};
+
+/**
+ * @brief Depth listener that ignores every level change
+ */
+struct NullDepthListener
+{
+  void onLevel(Side, Price, Size) {}
+};
+
+/**
+ * @brief Depth listener collecting level changes until the caller clears it
+ *
+ * @details With conflation on, repeated changes to one level between two
+ *          calls to clear() overwrite a single DepthUpdate in place, so each
+ *          batch publishes at most one update per level, in the order the
+ *          levels were first touched.
+ */
+class DepthFeed
+{
+public:
+  explicit DepthFeed(bool conflate = false)
+      : updates_{}, bidPending_{}, askPending_{}, conflate_{conflate}
+  {
+  }
+
+  void onLevel(Side side, Price price, Size size)
+  {
+    if (!conflate_)
+    {
+      updates_.push_back(DepthUpdate{side, price, size});
+      return;
+    }
+
+    // Prices are used as raw 64-bit keys
+    auto &pending = side == Side::Buy ? bidPending_ : askPending_;
+    auto [it, inserted] =
+        pending.try_emplace(static_cast<OrderId>(price), updates_.size());
+
+    if (inserted)
+    {
+      updates_.push_back(DepthUpdate{side, price, size});
+    }
+    else
+    {
+      updates_[it->second].size_ = size;
+    }
+  }
+
+  std::span<const DepthUpdate> updates() const { return updates_; }
+
+  bool conflating() const { return conflate_; }
+
+  /**
+   * @brief Ends the current batch
+   */
+  void clear()
+  {
+    if (conflate_)
+    {
+      for (const auto &update : updates_)
+      {
+        auto &pending = update.side_ == Side::Buy ? bidPending_ : askPending_;
+        pending.erase(static_cast<OrderId>(update.price_));
+      }
+    }
+    updates_.clear();
+  }
+
+private:
+  std::vector<DepthUpdate> updates_;
+  FlatOrderMap<std::size_t> bidPending_;
+  FlatOrderMap<std::size_t> askPending_;
+  bool conflate_;
+};
@@ -0,0 +1,204 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+#include "orderbook/command.h"
+#include "orderbook/cpu_affinity.h"
+#include "orderbook/order_index.h"
+#include "orderbook/spsc_ring.h"
+#include "orderbook/trade.h"
+#include "orderbook/types.h"
+
+/**
+ * @brief Routes commands for many symbols onto a fixed set of shard threads
+ *
+ * @details Symbols are hashed onto shards, and each shard owns the books of
+ *          its symbols, so a book is only ever touched by its shard's
+ *          thread. Commands reach a shard through its own SpscRing, which
+ *          makes submit() single-producer: call it from one thread only.
+ *
+ * @tparam Book     the OrderBook type kept for every symbol
+ */
+template <typename Book> class MatchingEngine
+{
+public:
+  /**
+   * @param shards          number of worker threads
+   * @param ringCapacity    commands that can be queued for each shard
+   * @param cores           if not empty, shard i is pinned to
+   *                        cores[i % cores.size()]
+   */
+  explicit MatchingEngine(std::size_t shards,
+                          std::size_t ringCapacity = 65536,
+                          std::span<const int> cores = {})
+      : shards_{}
+  {
+    for (std::size_t i = 0; i < shards; ++i)
+    {
+      shards_.push_back(std::make_unique<Shard>(ringCapacity));
+    }
+
+    for (std::size_t i = 0; i < shards; ++i)
+    {
+      auto *shard = shards_[i].get();
+      shard->worker_ =
+          std::jthread{[shard](std::stop_token stop) { shard->run(stop); }};
+
+      if (!cores.empty())
+      {
+        pinToCore(shard->worker_, cores[i % cores.size()]);
+      }
+    }
+  }
+
+  MatchingEngine(const MatchingEngine &) = delete;
+  MatchingEngine &operator=(const MatchingEngine &) = delete;
+
+  std::size_t shardCount() const { return shards_.size(); }
+
+  std::size_t shardOf(SymbolId symbol) const
+  {
+    // Fibonacci hashing keeps consecutive symbol ids on different shards
+    auto hash = (std::uint64_t{symbol} * 0x9E3779B97F4A7C15ull) >> 32;
+    return static_cast<std::size_t>(hash % shards_.size());
+  }
+
+  /**
+   * @brief Queues command for its symbol's shard, waiting while it is full
+   */
+  void submit(const Command &command)
+  {
+    auto &shard = *shards_[shardOf(command.symbol_)];
+    while (!shard.inbox_.tryPush(command))
+    {
+      std::this_thread::yield();
+    }
+    ++shard.submitted_;
+  }
+
+  /**
+   * @brief Queues command unless its shard is full
+   */
+  bool trySubmit(const Command &command)
+  {
+    auto &shard = *shards_[shardOf(command.symbol_)];
+    if (!shard.inbox_.tryPush(command))
+      return false;
+
+    ++shard.submitted_;
+    return true;
+  }
+
+  /**
+   * @brief Waits until every submitted command has been applied
+   *
+   * @details Until the next submit(), the books and counters may then be
+   *          read from the submitting thread.
+   */
+  void drain() const
+  {
+    for (const auto &shard : shards_)
+    {
+      while (shard->processed_.load(std::memory_order_acquire) <
+             shard->submitted_)
+      {
+        std::this_thread::yield();
+      }
+    }
+  }
+
+  /**
+   * @brief Book for symbol, or nullptr if no command has reached it
+   *
+   * @details Only call after drain().
+   */
+  const Book *find(SymbolId symbol) const
+  {
+    const auto &books = shards_[shardOf(symbol)]->books_;
+    auto it = books.find(symbol);
+    return it == books.end() ? nullptr : it->second;
+  }
+
+  /**
+   * @brief Executions across all shards, only call after drain()
+   */
+  std::size_t trades() const
+  {
+    std::size_t total = 0;
+    for (const auto &shard : shards_)
+    {
+      total += shard->trades_;
+    }
+    return total;
+  }
+
+private:
+  static constexpr std::size_t batchSize_ = 256;
+
+  struct Shard
+  {
+    explicit Shard(std::size_t ringCapacity)
+        : inbox_{ringCapacity}, books_{}, owned_{}, trades_{}, submitted_{},
+          processed_{}, worker_{}
+    {
+    }
+
+    void run(std::stop_token stop)
+    {
+      while (!stop.stop_requested())
+      {
+        auto count = inbox_.popBatch(
+            batchSize_,
+            [&](const Command &command)
+            {
+              command.applyTo(bookFor(command.symbol_),
+                              [&](const Trade &) { ++trades_; });
+            });
+
+        if (count == 0)
+        {
+          std::this_thread::yield();
+          continue;
+        }
+
+        processed_.store(processed_.load(std::memory_order_relaxed) + count,
+                         std::memory_order_release);
+      }
+    }
+
+    Book &bookFor(SymbolId symbol)
+    {
+      auto [it, inserted] = books_.try_emplace(symbol, nullptr);
+      if (inserted)
+      {
+        owned_.push_back(std::make_unique<Book>());
+        it->second = owned_.back().get();
+      }
+      return *it->second;
+    }
+
+    SpscRing<Command> inbox_;
+
+    // Worker thread only, read by others after drain()
+    FlatOrderMap<Book *> books_;
+    std::vector<std::unique_ptr<Book>> owned_;
+    std::size_t trades_;
+
+    // Submitting thread only
+    std::size_t submitted_;
+
+    alignas(SpscRing<Command>::cacheLineSize)
+        std::atomic<std::size_t> processed_;
+
+    std::jthread worker_;
+  };
+
+  std::vector<std::unique_ptr<Shard>> shards_;
+};
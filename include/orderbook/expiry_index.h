@@ -0,0 +1,129 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+#include "orderbook/order.h"
+#include "orderbook/order_index.h"
+#include "orderbook/types.h"
+
+/**
+ * @brief Resting GoodForDay orders bucketed by the time they expire
+ *
+ * @details Each bucket holds the orders sharing one expiry in a dense array,
+ *          and each order's place in it is kept by id, so a cancel or fill
+ *          takes the order out in O(1) by moving the bucket's last order
+ *          into its place. Buckets are ordered by expiry, so taking every
+ *          order due by some time touches only the buckets and orders due.
+ */
+class ExpiryIndex
+{
+public:
+  ExpiryIndex() : buckets_{}, positions_{} {}
+
+  bool empty() const { return positions_.empty(); }
+
+  std::size_t size() const { return positions_.size(); }
+
+  void insert(OrderPointer order, Timestamp expiry)
+  {
+    auto &bucket = buckets_[expiry];
+    positions_[order->getOrderId()] =
+        Position{expiry, static_cast<std::uint32_t>(bucket.size())};
+    bucket.push_back(order);
+  }
+
+  /**
+   * @brief Forgets order, if it is indexed
+   */
+  void erase(OrderPointer order)
+  {
+    auto it = positions_.find(order->getOrderId());
+    if (it == positions_.end())
+      return;
+
+    auto [expiry, index] = it->second;
+    positions_.erase(it);
+
+    auto bucket = buckets_.find(expiry);
+    auto &orders = bucket->second;
+    if (index + 1 != orders.size())
+    {
+      orders[index] = orders.back();
+      positions_.find(orders[index]->getOrderId())->second.index_ = index;
+    }
+    orders.pop_back();
+
+    if (orders.empty())
+    {
+      buckets_.erase(bucket);
+    }
+  }
+
+  /**
+   * @brief Number of orders expiring at or before now
+   */
+  std::size_t due(Timestamp now) const
+  {
+    std::size_t count = 0;
+    for (auto bucket = buckets_.begin(), last = buckets_.upper_bound(now);
+         bucket != last; ++bucket)
+    {
+      count += bucket->second.size();
+    }
+    return count;
+  }
+
+  /**
+   * @brief Appends every order expiring at or before now to expired and
+   *        forgets them
+   *
+   * @details expired is grown once, before anything is forgotten, so a
+   *          failed allocation leaves the index as it was.
+   */
+  void take(Timestamp now, std::vector<OrderPointer> &expired)
+  {
+    auto last = buckets_.upper_bound(now);
+    auto count = due(now);
+    expired.reserve(expired.size() + count);
+
+    // Every order is due at a session close, when ids need not be hashed
+    bool all = count == positions_.size();
+
+    for (auto bucket = buckets_.begin(); bucket != last; ++bucket)
+    {
+      for (auto order : bucket->second)
+      {
+        if (!all)
+        {
+          positions_.erase(order->getOrderId());
+        }
+        expired.push_back(order);
+      }
+    }
+    buckets_.erase(buckets_.begin(), last);
+
+    if (all)
+    {
+      positions_.clear();
+    }
+  }
+
+  void clear()
+  {
+    buckets_.clear();
+    positions_.clear();
+  }
+
+private:
+  struct Position
+  {
+    Timestamp expiry_;
+    std::uint32_t index_;
+  };
+
+  std::map<Timestamp, std::vector<OrderPointer>> buckets_;
+  FlatOrderMap<Position> positions_;
+};
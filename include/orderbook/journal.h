@@ -0,0 +1,356 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "orderbook/command.h"
+#include "orderbook/trade.h"
+
+/**
+ * @brief Journal that records nothing
+ */
+struct NullJournal
+{
+  void record(const Command &) {}
+};
+
+/**
+ * @brief One journal slot, valid while sequence_ follows the previous slot's
+ *        and checksum_ matches the sequence and command
+ */
+struct JournalRecord
+{
+  std::uint64_t sequence_;
+  std::uint64_t checksum_;
+  Command command_;
+};
+
+static_assert(std::is_trivially_copyable_v<JournalRecord>);
+static_assert(sizeof(Command) % sizeof(std::uint64_t) == 0);
+
+/**
+ * @brief Append-only command journal in a pre-sized memory-mapped file
+ *
+ * @details Records are copied straight into the shared mapping, so they
+ *          survive a crash of the process as soon as record() returns.
+ *          Surviving a crash of the machine needs flush(), which is issued
+ *          once per groupSize records so the msync cost is shared by the
+ *          group. Reopening an existing file appends after its last valid
+ *          record.
+ *
+ *          A record's command and checksum are written before its sequence
+ *          is published, and a record only counts as valid when both its
+ *          sequence and checksum hold, so a write torn by a crash ends the
+ *          journal rather than replaying a stale command.
+ *
+ *          There is no default constructor: a journal needs a file and a
+ *          capacity before it can take a record.
+ */
+class MappedJournal
+{
+public:
+  /**
+   * @param path        journal file, created if missing
+   * @param capacity    number of records the file is sized for
+   * @param groupSize   records between automatic flushes, 0 for none
+   */
+  MappedJournal(const std::string &path, std::size_t capacity,
+                std::size_t groupSize = 1024)
+      : MappedJournal{}
+  {
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd_ < 0)
+    {
+      throw std::system_error(errno, std::generic_category(), path);
+    }
+
+    struct stat info;
+    if (::fstat(fd_, &info) < 0)
+    {
+      throw std::system_error(errno, std::generic_category(), path);
+    }
+
+    auto bytes = std::max(static_cast<std::size_t>(info.st_size),
+                          headerSize_ + capacity * sizeof(JournalRecord));
+    if (static_cast<std::size_t>(info.st_size) < bytes &&
+        ::ftruncate(fd_, static_cast<off_t>(bytes)) < 0)
+    {
+      throw std::system_error(errno, std::generic_category(), path);
+    }
+
+    // Fault every page in now rather than on the first record written to it
+    map_ = static_cast<std::byte *>(::mmap(nullptr, bytes,
+                                           PROT_READ | PROT_WRITE,
+                                           MAP_SHARED | MAP_POPULATE, fd_, 0));
+    if (map_ == MAP_FAILED)
+    {
+      map_ = nullptr;
+      throw std::system_error(errno, std::generic_category(), path);
+    }
+
+    capacity_ = (bytes - headerSize_) / sizeof(JournalRecord);
+    group_ = groupSize;
+
+    Header header;
+    std::memcpy(&header, map_, sizeof(header));
+    if (header.magic_ == 0)
+    {
+      header = Header{magic_, sizeof(JournalRecord)};
+      std::memcpy(map_, &header, sizeof(header));
+    }
+    else if (header.magic_ != magic_ ||
+             header.recordSize_ != sizeof(JournalRecord))
+    {
+      throw std::runtime_error("Not a compatible journal: " + path);
+    }
+
+    size_ = count(map_, capacity_);
+    flushed_ = size_;
+
+    // Dirty the free pages up front so record() takes no write faults
+    static const auto page =
+        static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    for (auto *byte = slot(size_); byte < map_ + bytes; byte += page)
+    {
+      *byte = std::byte{};
+    }
+  }
+
+  MappedJournal(MappedJournal &&other) noexcept : MappedJournal{}
+  {
+    swap(other);
+  }
+
+  MappedJournal &operator=(MappedJournal &&other) noexcept
+  {
+    MappedJournal{std::move(other)}.swap(*this);
+    return *this;
+  }
+
+  ~MappedJournal()
+  {
+    if (map_)
+    {
+      flush();
+      ::munmap(map_, headerSize_ + capacity_ * sizeof(JournalRecord));
+    }
+    if (fd_ >= 0)
+    {
+      ::close(fd_);
+    }
+  }
+
+  std::size_t size() const { return size_; }
+  std::size_t capacity() const { return capacity_; }
+
+  /**
+   * @brief Throws, as record() would, unless count more records fit
+   *
+   * @details Lets a batch be refused before it changes anything.
+   */
+  void reserve(std::size_t count) const
+  {
+    if (count > capacity_ - size_)
+    {
+      throw std::runtime_error("Journal is full");
+    }
+  }
+
+  void record(const Command &command)
+  {
+    if (size_ == capacity_)
+    {
+      throw std::runtime_error("Journal is full");
+    }
+
+    auto *record = slot(size_);
+    auto sequence = static_cast<std::uint64_t>(size_ + 1);
+    std::memcpy(record + offsetof(JournalRecord, command_), &command,
+                sizeof(command));
+    auto sum = checksum(record, sequence);
+    std::memcpy(record + offsetof(JournalRecord, checksum_), &sum,
+                sizeof(sum));
+    std::atomic_ref{*reinterpret_cast<std::uint64_t *>(
+                        record + offsetof(JournalRecord, sequence_))}
+        .store(sequence, std::memory_order_release);
+    ++size_;
+
+    if (group_ != 0 && size_ - flushed_ >= group_)
+    {
+      flush();
+    }
+  }
+
+  /**
+   * @brief Writes records appended since the last flush through to disk
+   */
+  void flush()
+  {
+    if (size_ == flushed_)
+      return;
+
+    // msync needs a page-aligned start
+    static const auto page =
+        static_cast<std::uintptr_t>(::sysconf(_SC_PAGESIZE));
+    auto begin = reinterpret_cast<std::uintptr_t>(slot(flushed_));
+    auto end = reinterpret_cast<std::uintptr_t>(slot(size_));
+    begin &= ~(page - 1);
+
+    ::msync(reinterpret_cast<void *>(begin), end - begin, MS_SYNC);
+    flushed_ = size_;
+  }
+
+  /**
+   * @brief Passes every valid record of the journal at path to onCommand
+   *
+   * @return the number of records replayed
+   */
+  static std::size_t replay(const std::string &path, auto &&onCommand)
+  {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+      throw std::system_error(errno, std::generic_category(), path);
+    }
+
+    struct stat info;
+    if (::fstat(fd, &info) < 0 ||
+        static_cast<std::size_t>(info.st_size) < headerSize_)
+    {
+      ::close(fd);
+      return 0;
+    }
+
+    auto bytes = static_cast<std::size_t>(info.st_size);
+    auto *map = static_cast<std::byte *>(
+        ::mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0));
+    ::close(fd);
+    if (map == MAP_FAILED)
+    {
+      throw std::system_error(errno, std::generic_category(), path);
+    }
+
+    ::madvise(map, bytes, MADV_SEQUENTIAL);
+
+    auto capacity = (bytes - headerSize_) / sizeof(JournalRecord);
+    auto records = count(map, capacity);
+
+    for (std::size_t i = 0; i < records; ++i)
+    {
+      JournalRecord record;
+      std::memcpy(&record, map + headerSize_ + i * sizeof(JournalRecord),
+                  sizeof(record));
+      onCommand(record.command_);
+    }
+
+    ::munmap(map, bytes);
+    return records;
+  }
+
+  /**
+   * @brief Rebuilds book by applying every valid record of the journal
+   */
+  template <typename Book>
+  static std::size_t replayInto(const std::string &path, Book &book)
+  {
+    return replay(path, [&](const Command &command)
+                  { command.applyTo(book, [](const Trade &) {}); });
+  }
+
+private:
+  struct Header
+  {
+    std::uint64_t magic_;
+    std::uint64_t recordSize_;
+  };
+
+  static constexpr std::uint64_t magic_ = 0x4C4E524A4B424F4Full;
+  static constexpr std::size_t headerSize_ = 64;
+
+  MappedJournal() : fd_{-1}, map_{}, capacity_{}, size_{}, flushed_{}, group_{}
+  {
+  }
+
+  /**
+   * @brief Hash of sequence and the command bytes of the record at record
+   *
+   * @details Hashes the bytes as they lie in the mapping, padding included,
+   *          so writer and reader agree whatever the padding holds.
+   */
+  static std::uint64_t checksum(const std::byte *record,
+                                std::uint64_t sequence)
+  {
+    constexpr std::uint64_t multiplier = 0x9E3779B97F4A7C15ull;
+    auto hash = sequence * multiplier;
+    for (std::size_t offset = 0; offset < sizeof(Command);
+         offset += sizeof(std::uint64_t))
+    {
+      std::uint64_t word;
+      std::memcpy(&word, record + offsetof(JournalRecord, command_) + offset,
+                  sizeof(word));
+      hash = (hash ^ word) * multiplier;
+      hash ^= hash >> 29;
+    }
+    return hash;
+  }
+
+  /**
+   * @brief Number of leading records whose sequence numbers run 1, 2, ...
+   *        and whose checksums hold
+   */
+  static std::size_t count(const std::byte *map, std::size_t capacity)
+  {
+    std::size_t records = 0;
+    while (records < capacity)
+    {
+      const auto *record = map + headerSize_ + records * sizeof(JournalRecord);
+      std::uint64_t sequence;
+      std::uint64_t sum;
+      std::memcpy(&sequence, record + offsetof(JournalRecord, sequence_),
+                  sizeof(sequence));
+      std::memcpy(&sum, record + offsetof(JournalRecord, checksum_),
+                  sizeof(sum));
+      if (sequence != records + 1 || sum != checksum(record, sequence))
+        break;
+
+      ++records;
+    }
+    return records;
+  }
+
+  std::byte *slot(std::size_t index) const
+  {
+    return map_ + headerSize_ + index * sizeof(JournalRecord);
+  }
+
+  void swap(MappedJournal &other) noexcept
+  {
+    std::swap(fd_, other.fd_);
+    std::swap(map_, other.map_);
+    std::swap(capacity_, other.capacity_);
+    std::swap(size_, other.size_);
+    std::swap(flushed_, other.flushed_);
+    std::swap(group_, other.group_);
+  }
+
+  int fd_;
+  std::byte *map_;
+  std::size_t capacity_;
+  std::size_t size_;
+  std::size_t flushed_;
+  std::size_t group_;
+};
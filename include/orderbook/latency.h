@@ -0,0 +1,241 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "orderbook/types.h"
+
+enum class BookOperation : std::uint8_t
+{
+  Add,
+  Cancel,
+  Modify,
+};
+
+/**
+ * @brief Reads the time stamp counter, or steady_clock nanoseconds where
+ *        there is none
+ */
+inline std::uint64_t readTsc()
+{
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return static_cast<std::uint64_t>(
+      std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+/**
+ * @brief Log-linear histogram of tick counts in the style of HdrHistogram
+ *
+ * @details Values below 16 get a bucket each. Above that, every power of
+ *          two is split into 16 buckets, so a bucket is never wider than
+ *          1/16 of its value. Values beyond 2^40 ticks share the top
+ *          bucket. Recording is one index computation and two increments.
+ */
+class LatencyHistogram
+{
+public:
+  static constexpr unsigned subBucketBits_ = 4;
+  static constexpr unsigned maxBits_ = 40;
+  static constexpr std::size_t subBuckets_ = std::size_t{1} << subBucketBits_;
+  static constexpr std::size_t bucketCount_ =
+      (maxBits_ - subBucketBits_ + 1) * subBuckets_;
+
+  LatencyHistogram() : counts_{}, count_{}, max_{} {}
+
+  void record(std::uint64_t ticks)
+  {
+    ++counts_[indexOf(ticks)];
+    ++count_;
+    max_ = std::max(max_, ticks);
+  }
+
+  std::uint64_t count() const { return count_; }
+  std::uint64_t max() const { return max_; }
+
+  /**
+   * @brief Upper bound of the bucket holding the sample at quantile q
+   *
+   * @param q     fraction in [0, 1], e.g. 0.99 for p99
+   */
+  std::uint64_t percentile(double q) const
+  {
+    if (count_ == 0)
+      return 0;
+
+    auto rank = static_cast<std::uint64_t>(
+        std::ceil(q * static_cast<double>(count_)));
+    rank = std::clamp<std::uint64_t>(rank, 1, count_);
+
+    // The top bucket is unbounded, so it reports the largest sample
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i + 1 < bucketCount_; ++i)
+    {
+      seen += counts_[i];
+      if (seen >= rank)
+        return std::min(upperBound(i), max_);
+    }
+    return max_;
+  }
+
+  void merge(const LatencyHistogram &other)
+  {
+    for (std::size_t i = 0; i < bucketCount_; ++i)
+    {
+      counts_[i] += other.counts_[i];
+    }
+    count_ += other.count_;
+    max_ = std::max(max_, other.max_);
+  }
+
+  void reset()
+  {
+    counts_.fill(0);
+    count_ = 0;
+    max_ = 0;
+  }
+
+private:
+  static std::size_t indexOf(std::uint64_t ticks)
+  {
+    ticks = std::min(ticks, (std::uint64_t{1} << maxBits_) - 1);
+    if (ticks < subBuckets_)
+      return static_cast<std::size_t>(ticks);
+
+    auto shift = static_cast<unsigned>(std::bit_width(ticks)) - 1 -
+                 subBucketBits_;
+    return (shift + 1) * subBuckets_ +
+           static_cast<std::size_t>((ticks >> shift) - subBuckets_);
+  }
+
+  static std::uint64_t upperBound(std::size_t index)
+  {
+    if (index < subBuckets_)
+      return index;
+
+    auto shift = index / subBuckets_ - 1;
+    auto sub = std::uint64_t{index % subBuckets_ + subBuckets_};
+    return ((sub + 1) << shift) - 1;
+  }
+
+  std::array<std::uint64_t, bucketCount_> counts_;
+  std::uint64_t count_;
+  std::uint64_t max_;
+};
+
+/**
+ * @brief One LatencyHistogram per BookOperation and OrderType
+ */
+class LatencySnapshot
+{
+public:
+  static constexpr std::size_t operations_ =
+      static_cast<std::size_t>(BookOperation::Modify) + 1;
+  static constexpr std::size_t orderTypes_ =
+      static_cast<std::size_t>(OrderType::Market) + 1;
+
+  LatencySnapshot() : histograms_{} {}
+
+  LatencyHistogram &histogram(BookOperation operation, OrderType type)
+  {
+    return histograms_[static_cast<std::size_t>(operation)]
+                      [static_cast<std::size_t>(type)];
+  }
+
+  const LatencyHistogram &histogram(BookOperation operation,
+                                    OrderType type) const
+  {
+    return histograms_[static_cast<std::size_t>(operation)]
+                      [static_cast<std::size_t>(type)];
+  }
+
+  /**
+   * @brief Every order type's samples for operation, merged
+   */
+  LatencyHistogram histogram(BookOperation operation) const
+  {
+    LatencyHistogram merged;
+    for (const auto &histogram :
+         histograms_[static_cast<std::size_t>(operation)])
+    {
+      merged.merge(histogram);
+    }
+    return merged;
+  }
+
+  void merge(const LatencySnapshot &other)
+  {
+    for (std::size_t op = 0; op < operations_; ++op)
+    {
+      for (std::size_t type = 0; type < orderTypes_; ++type)
+      {
+        histograms_[op][type].merge(other.histograms_[op][type]);
+      }
+    }
+  }
+
+  void reset()
+  {
+    for (auto &histograms : histograms_)
+    {
+      for (auto &histogram : histograms)
+      {
+        histogram.reset();
+      }
+    }
+  }
+
+private:
+  std::array<std::array<LatencyHistogram, orderTypes_>, operations_>
+      histograms_;
+};
+
+/**
+ * @brief Latency recorder that measures nothing and compiles away
+ */
+struct NullLatencyRecorder
+{
+  std::uint64_t start() const { return 0; }
+  void stop(BookOperation, OrderType, std::uint64_t) {}
+};
+
+/**
+ * @brief Times book operations in TSC ticks
+ *
+ * @details The counter is read without serialising, which keeps the probe
+ *          to a few cycles and is accurate to within a few dozen ticks.
+ *          Ticks are not converted: divide by the TSC frequency for time.
+ */
+class TscLatencyRecorder
+{
+public:
+  TscLatencyRecorder() : snapshot_{} {}
+
+  std::uint64_t start() const { return readTsc(); }
+
+  void stop(BookOperation operation, OrderType type, std::uint64_t start)
+  {
+    snapshot_.histogram(operation, type).record(readTsc() - start);
+  }
+
+  /**
+   * @brief Histograms recorded since the last reset(); copy to keep them
+   */
+  const LatencySnapshot &snapshot() const { return snapshot_; }
+
+  void reset() { snapshot_.reset(); }
+
+private:
+  LatencySnapshot snapshot_;
+};
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Hierarchical 64-ary bitset for finding populated price slots
+ *
+ * @details Layer 0 holds one bit per slot. Each higher layer holds one bit
+ *          per word of the layer below, set while that word is non-zero.
+ *          Searches climb only until a word has a candidate bit and then
+ *          descend with one countr_zero/countl_zero per layer, so finding
+ *          the next populated slot costs O(log64 n) however many empty
+ *          slots lie in between.
+ */
+class LevelBitmap
+{
+public:
+  static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+  LevelBitmap() : layers_{}, size_{} {}
+
+  explicit LevelBitmap(std::size_t size) : LevelBitmap{} { resize(size); }
+
+  /**
+   * @brief Resizes to hold size slots, clearing every bit
+   */
+  void resize(std::size_t size)
+  {
+    size_ = size;
+    layers_.clear();
+
+    std::size_t words = (size + 63) / 64;
+    do
+    {
+      layers_.emplace_back(std::max<std::size_t>(words, 1));
+      words = (words + 63) / 64;
+    } while (layers_.back().size() > 1);
+  }
+
+  std::size_t size() const { return size_; }
+
+  bool none() const { return layers_.empty() || layers_.back()[0] == 0; }
+
+  bool test(std::size_t i) const
+  {
+    return (layers_[0][i / 64] >> (i % 64)) & 1;
+  }
+
+  void set(std::size_t i)
+  {
+    for (auto &layer : layers_)
+    {
+      auto &word = layer[i / 64];
+      bool wasEmpty = word == 0;
+      word |= std::uint64_t{1} << (i % 64);
+
+      if (!wasEmpty)
+        return;
+
+      i /= 64;
+    }
+  }
+
+  void reset(std::size_t i)
+  {
+    for (auto &layer : layers_)
+    {
+      auto &word = layer[i / 64];
+      word &= ~(std::uint64_t{1} << (i % 64));
+
+      if (word != 0)
+        return;
+
+      i /= 64;
+    }
+  }
+
+  /**
+   * @brief Lowest set slot at or after i, or npos
+   */
+  std::size_t findNext(std::size_t i) const
+  {
+    if (i >= size_)
+      return npos;
+
+    for (std::size_t layer = 0; layer < layers_.size(); ++layer)
+    {
+      const auto &words = layers_[layer];
+      if (i / 64 >= words.size())
+        return npos;
+
+      auto bits = words[i / 64] & (~std::uint64_t{0} << (i % 64));
+      if (bits)
+      {
+        i = (i & ~std::size_t{63}) + std::countr_zero(bits);
+        return descendLow(layer, i);
+      }
+
+      i = i / 64 + 1;
+    }
+    return npos;
+  }
+
+  /**
+   * @brief Highest set slot at or before i, or npos
+   */
+  std::size_t findPrev(std::size_t i) const
+  {
+    if (size_ == 0)
+      return npos;
+
+    if (i >= size_)
+    {
+      i = size_ - 1;
+    }
+
+    for (std::size_t layer = 0; layer < layers_.size(); ++layer)
+    {
+      const auto &words = layers_[layer];
+
+      auto bits = words[i / 64] & (~std::uint64_t{0} >> (63 - i % 64));
+      if (bits)
+      {
+        i = (i & ~std::size_t{63}) + 63 - std::countl_zero(bits);
+        return descendHigh(layer, i);
+      }
+
+      if (i < 64)
+        return npos;
+
+      i = i / 64 - 1;
+    }
+    return npos;
+  }
+
+  std::size_t first() const { return findNext(0); }
+
+  std::size_t last() const { return size_ == 0 ? npos : findPrev(size_ - 1); }
+
+private:
+  std::size_t descendLow(std::size_t layer, std::size_t i) const
+  {
+    while (layer-- > 0)
+    {
+      i = i * 64 + std::countr_zero(layers_[layer][i]);
+    }
+    return i;
+  }
+
+  std::size_t descendHigh(std::size_t layer, std::size_t i) const
+  {
+    while (layer-- > 0)
+    {
+      i = i * 64 + 63 - std::countl_zero(layers_[layer][i]);
+    }
+    return i;
+  }
+
+  std::vector<std::vector<std::uint64_t>> layers_;
+  std::size_t size_;
+};
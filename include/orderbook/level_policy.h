@@ -1,15 +1,23 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
 #include <list>
 #include <map>
 #include <memory>
+#include <span>
 #include <stdexcept>
 #include <unordered_map>
 #include <vector>
 
+#include "orderbook/level_bitmap.h"
 #include "orderbook/order.h"
 #include "orderbook/price_level.h"
+#include "orderbook/slot_table.h"
 #include "orderbook/trade.h"
 #include "orderbook/types.h"
 
@@ -22,7 +30,7 @@
 template <typename Compare, typename OrderContainer> class MapLevelPolicy
 {
 public:
-  MapLevelPolicy() : levels_{}, comp_{} {}
+  MapLevelPolicy() : levels_{}, handles_{}, comp_{} {}
 
   bool empty() const { return levels_.empty(); }
 
@@ -41,9 +49,9 @@ public:
   /**
    * @brief Checks if aggressing order can be completely filled
    *
-   * @details Double for-loop is used because of possibly AllOrNone resting
-   *          orders that may not be matchable to aggressor.
-   *          AllOrNone orders that are too big are skipped.
+   * @details Levels answer from their size aggregates and only walk their
+   *          orders when resting AllOrNone orders might be too big to match
+   *          the aggressor. AllOrNone orders that are too big are skipped.
    */
   bool canFullyFill(Price const &aggressorPrice, Size volumeNeeded) const
   {
@@ -52,121 +60,157 @@ public:
       if (comp_(aggressorPrice, level.price_))
         break;
 
-      for (const auto &resting : level.orders_)
-      {
-        if (resting->getOrderType() == OrderType::AllOrNone)
-        {
-          if (resting->getRemainingSize() > volumeNeeded)
-            continue;
-        }
-
-        volumeNeeded -= std::min(volumeNeeded, resting->getRemainingSize());
-        if (volumeNeeded == 0)
-          return true;
-      }
+      if (level.canFill(volumeNeeded))
+        return true;
     }
     return false;
   }
 
   /**
    * @brief Matches aggressing order against as many resting orders as possible
+   *
+   * @details Executions are reported through onTrade as they happen, and
+   *          each level's remaining volume through onLevel once it is done,
+   *          unless nothing traded there.
+   *
+   * @tparam AllOrNone  false when no AllOrNone order can be resting
    */
-  Trades match(OrderId const &orderId, Side const &side, Price const &price,
-               Size &volumeRemaining, const auto &onRemove)
+  template <bool AllOrNone = true>
+  void match(OrderId const &orderId, Side const &side, Price const &price,
+             Size &volumeRemaining, auto &&onTrade, const auto &onRemove,
+             auto &&onLevel)
   {
-    Trades matches;
-
     for (auto lvl = levels_.begin();
          lvl != levels_.end() && volumeRemaining > 0;)
     {
       if (price != MARKET_PRICE && comp_(price, lvl->first))
         break;
 
-      auto &[restingPrice, level] = *lvl;
-      auto &orders = level.orders_;
-
-      for (auto ord = orders.begin();
-           ord != orders.end() && volumeRemaining > 0;)
+      auto &level = lvl->second;
+      auto size = level.size_;
+      level.template match<AllOrNone>(orderId, side, volumeRemaining,
+                                      onTrade, onRemove);
+      if (level.size_ != size)
       {
-        auto resting = *ord;
-
-        if (resting->getOrderType() == OrderType::AllOrNone)
-        {
-          if (resting->getRemainingSize() > volumeRemaining)
-          {
-            ++ord;
-            continue;
-          }
-        }
-
-        Size tradeSize = std::min(volumeRemaining, resting->getRemainingSize());
-
-        TradeData incomingData{orderId, restingPrice, tradeSize};
-        TradeData restingData{resting->getOrderId(), restingPrice, tradeSize};
-
-        if (side == Side::Buy)
-        {
-          matches.emplace_back(incomingData, restingData);
-        }
-        else
-        {
-          matches.emplace_back(restingData, incomingData);
-        }
-
-        volumeRemaining -= tradeSize;
-        level.size_ -= tradeSize;
-        resting->fill(tradeSize);
-
-        if (resting->isFilled())
-        {
-          onRemove(resting->getOrderId());
-          ord = orders.erase(ord);
-        }
-        else
-        {
-          ++ord;
-        }
+        onLevel(level.price_, level.size_);
       }
 
-      if (orders.empty())
+      if (level.empty())
       {
-        lvl = levels_.erase(lvl);
+        lvl = erase(lvl);
       }
       else
       {
         ++lvl;
       }
     }
-    return matches;
   }
 
   /**
    * @brief Adds order to price level
+   *
+   * @return the level's volume after the add
    */
-  void add(OrderPointer order)
+  Size add(OrderPointer order)
   {
     auto [it, inserted] =
         levels_.try_emplace(order->getPrice(), order->getPrice());
     auto &[price, level] = *it;
-    level.size_ += order->getRemainingSize();
-    level.orders_.insert(order);
+
+    if (inserted)
+    {
+      level.handle_ = handles_.acquire(it);
+    }
+    level.add(order);
+    return level.size_;
   }
 
   /**
    * @brief Cancels order in price level
+   *
+   * @details The level is reached through the order's level handle rather
+   *          than a lookup by price.
+   *
+   * @return the level's volume after the cancel
    */
-  void cancel(OrderPointer order)
+  Size cancel(OrderPointer order)
   {
-    auto it = levels_.find(order->getPrice());
-    if (it == levels_.end())
-      return;
+    auto it = handles_[order->getLevelHandle()];
+
+    it->second.erase(order);
+    Size size = it->second.size_;
+
+    if (it->second.empty())
+    {
+      erase(it);
+    }
+    return size;
+  }
+
+  /**
+   * @brief Cancels orders that all rest at the same price
+   *
+   * @return the level's volume after the cancels
+   */
+  Size cancel(std::span<const OrderPointer> orders)
+  {
+    auto it = handles_[orders.front()->getLevelHandle()];
+
+    it->second.erase(orders);
+    Size size = it->second.size_;
+
+    if (it->second.empty())
+    {
+      erase(it);
+    }
+    return size;
+  }
+
+  /**
+   * @brief Takes size off a resting order, keeping its queue position
+   *
+   * @return the level's volume after the reduction
+   */
+  Size reduce(OrderPointer order, Size size)
+  {
+    auto &level = handles_[order->getLevelHandle()]->second;
+    level.reduce(order, size);
+    return level.size_;
+  }
+
+  /**
+   * @brief Passes the price and volume of up to count best levels to onLevel
+   */
+  void snapshot(std::size_t count, auto &&onLevel) const
+  {
+    for (auto lvl = levels_.begin(); lvl != levels_.end() && count > 0;
+         ++lvl, --count)
+    {
+      onLevel(lvl->first, lvl->second.size_);
+    }
+  }
 
-    it->second.orders_.erase(order);
-    it->second.size_ -= order->getRemainingSize();
+  /**
+   * @brief Passes every level to onLevel, best first
+   */
+  void visit(auto &&onLevel) const
+  {
+    for (const auto &[price, level] : levels_)
+    {
+      onLevel(level);
+    }
+  }
 
-    if (it->second.orders_.empty())
+  /**
+   * @brief Fills an empty container with levels, given best first
+   */
+  void restore(std::vector<PriceLevel<OrderContainer>> levels)
+  {
+    for (auto &level : levels)
     {
-      levels_.erase(it);
+      auto it =
+          levels_.emplace_hint(levels_.end(), level.price_, std::move(level));
+      it->second.setHandle(handles_.acquire(it));
     }
   }
 
@@ -193,7 +237,19 @@ public:
   }
 
 private:
-  std::map<Price, PriceLevel<OrderContainer>, Compare> levels_;
+  using Levels = std::map<Price, PriceLevel<OrderContainer>, Compare>;
+
+  Levels::iterator erase(Levels::iterator it)
+  {
+    handles_.release(it->second.handle_);
+    return levels_.erase(it);
+  }
+
+  Levels levels_;
+
+  // Each level's node, reached from the level handle on its orders
+  SlotTable<typename Levels::iterator> handles_;
+
   Compare comp_;
 };
 
@@ -206,7 +262,7 @@ private:
 template <typename Compare, typename OrderContainer> class VectorLevelPolicy
 {
 public:
-  VectorLevelPolicy() : levels_{}, comp_{} {}
+  VectorLevelPolicy() : levels_{}, handles_{}, comp_{} {}
 
   bool empty() const { return levels_.empty(); }
 
@@ -229,92 +285,43 @@ public:
       if (comp_(aggressorPrice, level->price_))
         break;
 
-      for (const auto &resting : level->orders_)
-      {
-        if (resting->getOrderType() == OrderType::AllOrNone)
-        {
-          if (resting->getRemainingSize() > volumeNeeded)
-            continue;
-        }
-
-        volumeNeeded -= std::min(volumeNeeded, resting->getRemainingSize());
-        if (volumeNeeded == 0)
-          return true;
-      }
+      if (level->canFill(volumeNeeded))
+        return true;
     }
     return false;
   }
 
-  Trades match(OrderId const &orderId, Side const &side, Price const &price,
-               Size &volumeRemaining, const auto &onRemove)
+  template <bool AllOrNone = true>
+  void match(OrderId const &orderId, Side const &side, Price const &price,
+             Size &volumeRemaining, auto &&onTrade, const auto &onRemove,
+             auto &&onLevel)
   {
-    Trades matches;
-
     for (auto level = levels_.rbegin();
          level != levels_.rend() && volumeRemaining > 0;)
     {
       if (price != MARKET_PRICE && comp_(price, level->price_))
         break;
 
-      auto &orders = level->orders_;
-
-      for (auto ord = orders.begin();
-           ord != orders.end() && volumeRemaining > 0;)
+      auto size = level->size_;
+      level->template match<AllOrNone>(orderId, side, volumeRemaining,
+                                       onTrade, onRemove);
+      if (level->size_ != size)
       {
-        auto resting = *ord;
-
-        if (resting->getOrderType() == OrderType::AllOrNone)
-        {
-          if (resting->getRemainingSize() > volumeRemaining)
-          {
-            ++ord;
-            continue;
-          }
-        }
-
-        Size tradeSize = std::min(volumeRemaining, resting->getRemainingSize());
-
-        TradeData incomingData{orderId, level->price_, tradeSize};
-        TradeData restingData{resting->getOrderId(), level->price_, tradeSize};
-
-        if (side == Side::Buy)
-        {
-          matches.emplace_back(incomingData, restingData);
-        }
-        else
-        {
-          matches.emplace_back(restingData, incomingData);
-        }
-
-        volumeRemaining -= tradeSize;
-        level->size_ -= tradeSize;
-        resting->fill(tradeSize);
-
-        if (resting->isFilled())
-        {
-          onRemove(resting->getOrderId());
-          ord = orders.erase(ord);
-        }
-        else
-        {
-          ++ord;
-        }
+        onLevel(level->price_, level->size_);
       }
 
-      if (orders.empty())
+      if (level->empty())
       {
-        level =
-            std::make_reverse_iterator(levels_.erase(std::next(level).base()));
+        level = std::make_reverse_iterator(erase(std::next(level).base()));
       }
       else
       {
         ++level;
       }
     }
-    return matches;
   }
 
-  void add(OrderPointer order)
+  Size add(OrderPointer order)
   {
     Price orderPrice = order->getPrice();
 
@@ -323,36 +330,79 @@ public:
         [&](const PriceLevel<OrderContainer> &level, Price price)
         { return comp_(price, level.price_); });
 
-    if (lvl != levels_.end() && lvl->price_ == orderPrice)
+    if (lvl == levels_.end() || lvl->price_ != orderPrice)
     {
-      lvl->size_ += order->getRemainingSize();
-      lvl->orders_.insert(order);
+      auto index = static_cast<std::size_t>(lvl - levels_.begin());
+      lvl = levels_.emplace(lvl, orderPrice);
+      lvl->handle_ = handles_.acquire(index);
+      reindex(index + 1);
     }
-    else
+    lvl->add(order);
+    return lvl->size_;
+  }
+
+  Size cancel(OrderPointer order)
+  {
+    auto lvl = levels_.begin() + handles_[order->getLevelHandle()];
+
+    lvl->erase(order);
+    Size size = lvl->size_;
+
+    if (lvl->empty())
     {
-      lvl = levels_.emplace(lvl, orderPrice);
-      lvl->orders_.insert(order);
-      lvl->size_ += order->getRemainingSize();
+      erase(lvl);
     }
+    return size;
   }
 
-  void cancel(OrderPointer order)
+  Size cancel(std::span<const OrderPointer> orders)
   {
-    Price orderPrice = order->getPrice();
+    auto lvl = levels_.begin() + handles_[orders.front()->getLevelHandle()];
 
-    auto lvl = std::find_if(levels_.begin(), levels_.end(),
-                            [&](const PriceLevel<OrderContainer> &level)
-                            { return orderPrice == level.price_; });
+    lvl->erase(orders);
+    Size size = lvl->size_;
 
-    if (lvl != levels_.end() && lvl->price_ == orderPrice)
+    if (lvl->empty())
     {
-      lvl->orders_.erase(order);
-      lvl->size_ -= order->getRemainingSize();
+      erase(lvl);
+    }
+    return size;
+  }
 
-      if (lvl->orders_.empty())
-      {
-        levels_.erase(lvl);
-      }
+  Size reduce(OrderPointer order, Size size)
+  {
+    auto lvl = levels_.begin() + handles_[order->getLevelHandle()];
+
+    lvl->reduce(order, size);
+    return lvl->size_;
+  }
+
+  void snapshot(std::size_t count, auto &&onLevel) const
+  {
+    for (auto level = levels_.crbegin(); level != levels_.crend() && count > 0;
+         ++level, --count)
+    {
+      onLevel(level->price_, level->size_);
+    }
+  }
+
+  void visit(auto &&onLevel) const
+  {
+    for (auto level = levels_.crbegin(); level != levels_.crend(); ++level)
+    {
+      onLevel(*level);
+    }
+  }
+
+  void restore(std::vector<PriceLevel<OrderContainer>> levels)
+  {
+    // Stored worst first so the best level sits at the back
+    std::reverse(levels.begin(), levels.end());
+    levels_ = std::move(levels);
+
+    for (std::size_t i = 0; i < levels_.size(); ++i)
+    {
+      levels_[i].setHandle(handles_.acquire(i));
     }
   }
 
@@ -377,14 +427,44 @@ public:
   }
 
 private:
-  std::vector<PriceLevel<OrderContainer>> levels_;
+  using Levels = std::vector<PriceLevel<OrderContainer>>;
+
+  Levels::iterator erase(Levels::iterator lvl)
+  {
+    auto index = static_cast<std::size_t>(lvl - levels_.begin());
+    handles_.release(lvl->handle_);
+    lvl = levels_.erase(lvl);
+    reindex(index);
+    return lvl;
+  }
+
+  /**
+   * @brief Points the handles of levels from index first onwards at them
+   *        again after an insert or erase shifted them
+   *
+   * @details Costs as much as the shift did, and nothing for the best
+   *          level, which sits at the back.
+   */
+  void reindex(std::size_t first)
+  {
+    for (auto i = first; i < levels_.size(); ++i)
+    {
+      handles_[levels_[i].handle_] = i;
+    }
+  }
+
+  Levels levels_;
+
+  // Each level's index, reached from the level handle on its orders
+  SlotTable<std::size_t> handles_;
+
   Compare comp_;
 };
 
 template <typename Compare, typename OrderContainer> class ListLevelPolicy
 {
 public:
-  ListLevelPolicy() : levels_{}, comp_{} {}
+  ListLevelPolicy() : levels_{}, handles_{}, comp_{} {}
 
   bool empty() const { return levels_.empty(); }
 
@@ -407,91 +487,43 @@ public:
       if (comp_(aggressorPrice, level->price_))
         break;
 
-      for (const auto &resting : level->orders_)
-      {
-        if (resting->getOrderType() == OrderType::AllOrNone)
-        {
-          if (resting->getRemainingSize() > volumeNeeded)
-            continue;
-        }
-
-        volumeNeeded -= std::min(volumeNeeded, resting->getRemainingSize());
-        if (volumeNeeded == 0)
-          return true;
-      }
+      if (level->canFill(volumeNeeded))
+        return true;
     }
     return false;
   }
 
-  Trades match(OrderId const &orderId, Side const &side, Price const &price,
-               Size &volumeRemaining, const auto &onRemove)
+  template <bool AllOrNone = true>
+  void match(OrderId const &orderId, Side const &side, Price const &price,
+             Size &volumeRemaining, auto &&onTrade, const auto &onRemove,
+             auto &&onLevel)
   {
-    Trades matches;
-
     for (auto level = levels_.begin();
          level != levels_.end() && volumeRemaining > 0;)
     {
       if (price != MARKET_PRICE && comp_(price, level->price_))
         break;
 
-      auto &orders = level->orders_;
-
-      for (auto ord = orders.begin();
-           ord != orders.end() && volumeRemaining > 0;)
+      auto size = level->size_;
+      level->template match<AllOrNone>(orderId, side, volumeRemaining,
+                                       onTrade, onRemove);
+      if (level->size_ != size)
       {
-        auto resting = *ord;
-
-        if (resting->getOrderType() == OrderType::AllOrNone)
-        {
-          if (resting->getRemainingSize() > volumeRemaining)
-          {
-            ++ord;
-            continue;
-          }
-        }
-
-        Size tradeSize = std::min(volumeRemaining, resting->getRemainingSize());
-
-        TradeData incomingData{orderId, level->price_, tradeSize};
-        TradeData restingData{resting->getOrderId(), level->price_, tradeSize};
-
-        if (side == Side::Buy)
-        {
-          matches.emplace_back(incomingData, restingData);
-        }
-        else
-        {
-          matches.emplace_back(restingData, incomingData);
-        }
-
-        volumeRemaining -= tradeSize;
-        level->size_ -= tradeSize;
-        resting->fill(tradeSize);
-
-        if (resting->isFilled())
-        {
-          onRemove(resting->getOrderId());
-          ord = orders.erase(ord);
-        }
-        else
-        {
-          ++ord;
-        }
+        onLevel(level->price_, level->size_);
       }
 
-      if (orders.empty())
+      if (level->empty())
       {
-        level = levels_.erase(level);
+        level = erase(level);
       }
       else
       {
         ++level;
       }
     }
-    return matches;
   }
 
-  void add(OrderPointer order)
+  Size add(OrderPointer order)
   {
     Price orderPrice = order->getPrice();
 
@@ -500,37 +532,76 @@ public:
         [&](const PriceLevel<OrderContainer> &level, Price price)
         { return comp_(level.price_, price); });
 
-    if (it != levels_.end() && it->price_ == orderPrice)
+    if (it == levels_.end() || it->price_ != orderPrice)
     {
-      it->size_ += order->getRemainingSize();
-      it->orders_.insert(order);
+      it = levels_.emplace(it, orderPrice);
+      it->handle_ = handles_.acquire(it);
     }
-    else
+    it->add(order);
+    return it->size_;
+  }
+
+  Size cancel(OrderPointer order)
+  {
+    auto it = handles_[order->getLevelHandle()];
+
+    it->erase(order);
+    Size size = it->size_;
+
+    if (it->empty())
     {
-      it = levels_.emplace(it, orderPrice);
-      it->orders_.insert(order);
-      it->size_ += order->getRemainingSize();
+      erase(it);
     }
+    return size;
   }
 
-  void cancel(OrderPointer order)
+  Size cancel(std::span<const OrderPointer> orders)
   {
-    Price orderPrice = order->getPrice();
+    auto it = handles_[orders.front()->getLevelHandle()];
 
-    auto it = std::lower_bound(
-        levels_.begin(), levels_.end(), orderPrice,
-        [&](const PriceLevel<OrderContainer> &level, Price price)
-        { return comp_(level.price_, price); });
+    it->erase(orders);
+    Size size = it->size_;
 
-    if (it != levels_.end() && it->price_ == orderPrice)
+    if (it->empty())
     {
-      it->size_ -= order->getRemainingSize();
-      it->orders_.erase(order);
+      erase(it);
+    }
+    return size;
+  }
 
-      if (it->orders_.empty())
-      {
-        levels_.erase(it);
-      }
+  Size reduce(OrderPointer order, Size size)
+  {
+    auto it = handles_[order->getLevelHandle()];
+
+    it->reduce(order, size);
+    return it->size_;
+  }
+
+  void snapshot(std::size_t count, auto &&onLevel) const
+  {
+    for (auto level = levels_.cbegin(); level != levels_.cend() && count > 0;
+         ++level, --count)
+    {
+      onLevel(level->price_, level->size_);
+    }
+  }
+
+  void visit(auto &&onLevel) const
+  {
+    for (const auto &level : levels_)
+    {
+      onLevel(level);
+    }
+  }
+
+  void restore(std::vector<PriceLevel<OrderContainer>> levels)
+  {
+    levels_.assign(std::make_move_iterator(levels.begin()),
+                   std::make_move_iterator(levels.end()));
+
+    for (auto it = levels_.begin(); it != levels_.end(); ++it)
+    {
+      it->setHandle(handles_.acquire(it));
     }
   }
 
@@ -555,6 +626,861 @@ public:
   }
 
 private:
-  std::list<PriceLevel<OrderContainer>> levels_;
+  using Levels = std::list<PriceLevel<OrderContainer>>;
+
+  Levels::iterator erase(Levels::iterator it)
+  {
+    handles_.release(it->handle_);
+    return levels_.erase(it);
+  }
+
+  Levels levels_;
+
+  // Each level's node, reached from the level handle on its orders
+  SlotTable<typename Levels::iterator> handles_;
+
   Compare comp_;
 };
+
+/**
+ * @brief Orderbook price levels are stored in a flat array indexed by tick
+ *
+ * @details Slot i holds the handle of the level at base + i * TickSize,
+ *          and the levels themselves live in a SlotTable, so an empty tick
+ *          costs four bytes rather than a PriceLevel and its queue. A
+ *          LevelBitmap tracks non-empty slots so the best price and the
+ *          next level in match are found without visiting empty slots, and
+ *          orders reach their level through its handle. When an
+ *          order arrives outside the window, the window is rebuilt over
+ *          the populated range, sized from WindowTicks up so it also shrinks
+ *          once far prices have left. The window never grows past
+ *          MaxWindowTicks; accepts() tells whether a price still fits, and
+ *          add() must only be given prices it accepts. Prices are expected
+ *          to be multiples of TickSize.
+ *
+ * @tparam Compare          the comparator giving price priority
+ * @tparam OrderContainer   the type of container storing Order pointers
+ * @tparam WindowTicks      least number of ticks covered by the array
+ * @tparam TickSize         price distance between adjacent slots
+ * @tparam MaxWindowTicks   most ticks the array may cover
+ */
+template <typename Compare, typename OrderContainer,
+          std::size_t WindowTicks = 1024, Price TickSize = 1,
+          std::size_t MaxWindowTicks = WindowTicks * 1024>
+class BasicArrayLevelPolicy
+{
+  static_assert(WindowTicks > 0 && TickSize > 0);
+  static_assert(MaxWindowTicks >= WindowTicks);
+
+  using Level = PriceLevel<OrderContainer>;
+
+  static constexpr std::size_t npos = LevelBitmap::npos;
+  static constexpr bool ascending_ = Compare{}(Price{0}, Price{1});
+
+public:
+  /**
+   * @brief Visits occupied levels in price priority order
+   */
+  template <typename Policy, typename Value> class basic_iterator
+  {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = Level;
+    using difference_type = std::ptrdiff_t;
+    using pointer = Value *;
+    using reference = Value &;
+
+    basic_iterator() : policy_{}, index_{npos} {}
+    basic_iterator(Policy *policy, std::size_t index)
+        : policy_{policy}, index_{index}
+    {
+    }
+
+    reference operator*() const { return policy_->at(index_); }
+    pointer operator->() const { return &policy_->at(index_); }
+
+    basic_iterator &operator++()
+    {
+      index_ = policy_->nextIndex(index_);
+      return *this;
+    }
+
+    basic_iterator operator++(int)
+    {
+      auto prev = *this;
+      ++*this;
+      return prev;
+    }
+
+    bool operator==(const basic_iterator &other) const
+    {
+      return index_ == other.index_;
+    }
+
+  private:
+    Policy *policy_;
+    std::size_t index_;
+  };
+
+  using iterator = basic_iterator<BasicArrayLevelPolicy, Level>;
+  using const_iterator =
+      basic_iterator<const BasicArrayLevelPolicy, const Level>;
+
+  BasicArrayLevelPolicy()
+      : slots_{}, levels_{}, occupied_{}, base_{}, count_{}, comp_{}
+  {
+  }
+
+  bool empty() const { return count_ == 0; }
+
+  Price getBest() const
+  {
+    if (empty())
+    {
+      throw std::runtime_error("Level is empty");
+    }
+    else
+    {
+      return at(bestIndex()).price_;
+    }
+  }
+
+  /**
+   * @brief Whether the window can grow to cover the book and low to high
+   */
+  bool accepts(Price low, Price high) const
+  {
+    if (!empty())
+    {
+      low = std::min(low, at(occupied_.first()).price_);
+      high = std::max(high, at(occupied_.last()).price_);
+    }
+    return low <= high && (high - low) / TickSize <
+                              static_cast<Price>(MaxWindowTicks);
+  }
+
+  bool canFullyFill(Price const &aggressorPrice, Size volumeNeeded) const
+  {
+    for (auto i = bestIndex(); i != npos; i = nextIndex(i))
+    {
+      const auto &level = at(i);
+
+      if (comp_(aggressorPrice, level.price_))
+        break;
+
+      if (level.canFill(volumeNeeded))
+        return true;
+    }
+    return false;
+  }
+
+  template <bool AllOrNone = true>
+  void match(OrderId const &orderId, Side const &side, Price const &price,
+             Size &volumeRemaining, auto &&onTrade, const auto &onRemove,
+             auto &&onLevel)
+  {
+    for (auto i = bestIndex(); i != npos && volumeRemaining > 0;
+         i = nextIndex(i))
+    {
+      auto &level = at(i);
+
+      if (price != MARKET_PRICE && comp_(price, level.price_))
+        break;
+
+      auto size = level.size_;
+      level.template match<AllOrNone>(orderId, side, volumeRemaining,
+                                      onTrade, onRemove);
+      if (level.size_ != size)
+      {
+        onLevel(level.price_, level.size_);
+      }
+
+      if (level.empty())
+      {
+        release(i);
+      }
+    }
+  }
+
+  Size add(OrderPointer order)
+  {
+    Price orderPrice = order->getPrice();
+
+    if (!inWindow(orderPrice))
+    {
+      recentre(orderPrice);
+    }
+
+    auto i = indexOf(orderPrice);
+    if (!occupied_.test(i))
+    {
+      auto handle = levels_.acquire(Level{orderPrice});
+      levels_[handle].handle_ = handle;
+      slots_[i] = handle;
+      occupied_.set(i);
+      ++count_;
+    }
+
+    auto &level = at(i);
+    level.add(order);
+    return level.size_;
+  }
+
+  Size cancel(OrderPointer order)
+  {
+    auto &level = levels_[order->getLevelHandle()];
+    level.erase(order);
+
+    if (level.empty())
+    {
+      release(indexOf(level.price_));
+    }
+    return level.size_;
+  }
+
+  Size cancel(std::span<const OrderPointer> orders)
+  {
+    auto &level = levels_[orders.front()->getLevelHandle()];
+    level.erase(orders);
+
+    if (level.empty())
+    {
+      release(indexOf(level.price_));
+    }
+    return level.size_;
+  }
+
+  Size reduce(OrderPointer order, Size size)
+  {
+    auto &level = levels_[order->getLevelHandle()];
+    level.reduce(order, size);
+    return level.size_;
+  }
+
+  void snapshot(std::size_t count, auto &&onLevel) const
+  {
+    for (auto i = bestIndex(); i != npos && count > 0;
+         i = nextIndex(i), --count)
+    {
+      onLevel(at(i).price_, at(i).size_);
+    }
+  }
+
+  void visit(auto &&onLevel) const
+  {
+    for (auto i = bestIndex(); i != npos; i = nextIndex(i))
+    {
+      onLevel(at(i));
+    }
+  }
+
+  /**
+   * @brief Fills an empty container with levels, given best first
+   *
+   * @details The window is sized once for the whole range of prices,
+   *          which accepts() must allow.
+   */
+  void restore(std::vector<Level> levels)
+  {
+    if (levels.empty())
+      return;
+
+    Price low = std::min(levels.front().price_, levels.back().price_);
+    Price high = std::max(levels.front().price_, levels.back().price_);
+    rebuild(low, high);
+
+    for (auto &level : levels)
+    {
+      auto i = indexOf(level.price_);
+      auto handle = levels_.acquire(std::move(level));
+      levels_[handle].setHandle(handle);
+      slots_[i] = handle;
+      occupied_.set(i);
+      ++count_;
+    }
+  }
+
+  iterator begin() { return iterator{this, bestIndex()}; }
+
+  iterator end() { return iterator{}; }
+
+  const_iterator begin() const { return const_iterator{this, bestIndex()}; }
+
+  const_iterator end() const { return const_iterator{}; }
+
+private:
+  Level &at(std::size_t i) { return levels_[slots_[i]]; }
+
+  const Level &at(std::size_t i) const { return levels_[slots_[i]]; }
+
+  bool inWindow(Price price) const
+  {
+    return !slots_.empty() && price >= base_ &&
+           (price - base_) / TickSize < static_cast<Price>(slots_.size());
+  }
+
+  std::size_t indexOf(Price price) const
+  {
+    return static_cast<std::size_t>((price - base_) / TickSize);
+  }
+
+  void release(std::size_t i)
+  {
+    levels_.release(slots_[i]);
+    occupied_.reset(i);
+    --count_;
+  }
+
+  std::size_t bestIndex() const
+  {
+    if (empty())
+      return npos;
+
+    return ascending_ ? occupied_.first() : occupied_.last();
+  }
+
+  std::size_t nextIndex(std::size_t i) const
+  {
+    if (ascending_)
+    {
+      return occupied_.findNext(i + 1);
+    }
+    else
+    {
+      return i > 0 ? occupied_.findPrev(i - 1) : npos;
+    }
+  }
+
+  /**
+   * @brief Moves the window so it covers both the book and price
+   */
+  void recentre(Price price)
+  {
+    Price low = price;
+    Price high = price;
+
+    if (!empty())
+    {
+      low = std::min(low, at(occupied_.first()).price_);
+      high = std::max(high, at(occupied_.last()).price_);
+    }
+
+    rebuild(low, high);
+  }
+
+  /**
+   * @brief Sizes and places the window over low to high, moving the level
+   *        handles
+   *
+   * @details The window is given room for the range to double, up to
+   *          MaxWindowTicks. Levels stay where they are in the SlotTable.
+   */
+  void rebuild(Price low, Price high)
+  {
+    auto span = static_cast<std::size_t>((high - low) / TickSize) + 1;
+    auto ticks = WindowTicks;
+    while (ticks < 2 * span && ticks < MaxWindowTicks)
+    {
+      ticks *= 2;
+    }
+    ticks = std::min(ticks, MaxWindowTicks);
+
+    Price base = low - static_cast<Price>((ticks - span) / 2) * TickSize;
+
+    std::vector<std::uint32_t> slots(ticks);
+    LevelBitmap occupied{ticks};
+
+    for (auto i = occupied_.first(); i != npos; i = occupied_.findNext(i + 1))
+    {
+      auto j = static_cast<std::size_t>((at(i).price_ - base) / TickSize);
+      slots[j] = slots_[i];
+      occupied.set(j);
+    }
+
+    slots_ = std::move(slots);
+    occupied_ = std::move(occupied);
+    base_ = base;
+  }
+
+  // Handle of the level at each occupied tick
+  std::vector<std::uint32_t> slots_;
+  SlotTable<Level> levels_;
+  LevelBitmap occupied_;
+  Price base_;
+  std::size_t count_;
+  Compare comp_;
+};
+
+template <typename Compare, typename OrderContainer>
+using ArrayLevelPolicy = BasicArrayLevelPolicy<Compare, OrderContainer>;
+
+/**
+ * @brief Orderbook price levels are indexed by a chunked sorted array
+ *
+ * @details Prices are kept in order across chunks of ChunkLevels, worst
+ *          first, so the best level sits at the back of the last chunk and
+ *          match drops it without shifting anything. A chunk's prices fill
+ *          a cache line and are scanned in place once binary search over
+ *          the chunks has picked one. A full chunk is split in two and a
+ *          chunk left with few prices is merged into a neighbour, so an
+ *          insert or erase shifts one chunk's entries and, when it splits
+ *          or merges, a chunk array ChunkLevels times shorter than
+ *          VectorLevelPolicy's. Levels themselves are held in a SlotTable
+ *          and the handle on each order is their slot in it, which never
+ *          changes as chunks shift around it.
+ *
+ * @tparam Compare          the comparator giving price priority
+ * @tparam OrderContainer   the type of container storing Order pointers
+ * @tparam ChunkLevels      number of prices per chunk
+ */
+template <typename Compare, typename OrderContainer,
+          std::size_t ChunkLevels = 8>
+class BasicChunkedLevelPolicy
+{
+  static_assert(ChunkLevels >= 2);
+
+  using Level = PriceLevel<OrderContainer>;
+
+  static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+  /**
+   * @brief Up to ChunkLevels consecutive prices, worst first, and the
+   *        handles of their levels
+   */
+  struct Chunk
+  {
+    alignas(64) std::array<Price, ChunkLevels> prices_;
+    std::array<std::uint32_t, ChunkLevels> handles_;
+    std::size_t size_;
+
+    Chunk() : prices_{}, handles_{}, size_{} {}
+  };
+
+  /**
+   * @brief A level's place in the chunks, or npos past the worst level
+   */
+  struct Cursor
+  {
+    std::size_t chunk_;
+    std::size_t slot_;
+  };
+
+public:
+  /**
+   * @brief Visits levels in price priority order
+   */
+  template <typename Policy, typename Value> class basic_iterator
+  {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = Level;
+    using difference_type = std::ptrdiff_t;
+    using pointer = Value *;
+    using reference = Value &;
+
+    basic_iterator() : policy_{}, cursor_{npos, 0} {}
+    basic_iterator(Policy *policy, Cursor cursor)
+        : policy_{policy}, cursor_{cursor}
+    {
+    }
+
+    reference operator*() const { return policy_->at(cursor_); }
+    pointer operator->() const { return &policy_->at(cursor_); }
+
+    basic_iterator &operator++()
+    {
+      cursor_ = policy_->next(cursor_);
+      return *this;
+    }
+
+    basic_iterator operator++(int)
+    {
+      auto prev = *this;
+      ++*this;
+      return prev;
+    }
+
+    bool operator==(const basic_iterator &other) const
+    {
+      return cursor_.chunk_ == other.cursor_.chunk_ &&
+             (cursor_.chunk_ == npos || cursor_.slot_ == other.cursor_.slot_);
+    }
+
+  private:
+    Policy *policy_;
+    Cursor cursor_;
+  };
+
+  using iterator = basic_iterator<BasicChunkedLevelPolicy, Level>;
+  using const_iterator =
+      basic_iterator<const BasicChunkedLevelPolicy, const Level>;
+
+  BasicChunkedLevelPolicy() : chunks_{}, levels_{}, comp_{} {}
+
+  bool empty() const { return chunks_.empty(); }
+
+  /**
+   * @brief Number of chunks holding the levels
+   */
+  std::size_t chunkCount() const { return chunks_.size(); }
+
+  Price getBest() const
+  {
+    if (empty())
+    {
+      throw std::runtime_error("Level is empty");
+    }
+    else
+    {
+      return at(best()).price_;
+    }
+  }
+
+  bool canFullyFill(Price const &aggressorPrice, Size volumeNeeded) const
+  {
+    for (auto cursor = best(); cursor.chunk_ != npos; cursor = next(cursor))
+    {
+      const auto &level = at(cursor);
+
+      if (comp_(aggressorPrice, level.price_))
+        break;
+
+      if (level.canFill(volumeNeeded))
+        return true;
+    }
+    return false;
+  }
+
+  template <bool AllOrNone = true>
+  void match(OrderId const &orderId, Side const &side, Price const &price,
+             Size &volumeRemaining, auto &&onTrade, const auto &onRemove,
+             auto &&onLevel)
+  {
+    for (auto cursor = best(); cursor.chunk_ != npos && volumeRemaining > 0;)
+    {
+      auto &level = at(cursor);
+
+      if (price != MARKET_PRICE && comp_(price, level.price_))
+        break;
+
+      auto size = level.size_;
+      level.template match<AllOrNone>(orderId, side, volumeRemaining,
+                                      onTrade, onRemove);
+      if (level.size_ != size)
+      {
+        onLevel(level.price_, level.size_);
+      }
+
+      if (level.empty())
+      {
+        cursor = erase(cursor);
+      }
+      else
+      {
+        cursor = next(cursor);
+      }
+    }
+  }
+
+  Size add(OrderPointer order)
+  {
+    Price orderPrice = order->getPrice();
+
+    if (empty())
+    {
+      chunks_.emplace_back();
+    }
+
+    auto cursor = find(orderPrice);
+    auto &chunk = chunks_[cursor.chunk_];
+
+    std::uint32_t handle;
+    if (cursor.slot_ < chunk.size_ && chunk.prices_[cursor.slot_] == orderPrice)
+    {
+      handle = chunk.handles_[cursor.slot_];
+    }
+    else
+    {
+      handle = insert(cursor, orderPrice);
+    }
+
+    auto &level = levels_[handle];
+    level.add(order);
+    return level.size_;
+  }
+
+  /**
+   * @brief Cancels order in its level, reached through its level handle
+   *
+   * @return the level's volume after the cancel
+   */
+  Size cancel(OrderPointer order)
+  {
+    auto &level = levels_[order->getLevelHandle()];
+    level.erase(order);
+    Size size = level.size_;
+
+    if (level.empty())
+    {
+      erase(find(level.price_));
+    }
+    return size;
+  }
+
+  Size cancel(std::span<const OrderPointer> orders)
+  {
+    auto &level = levels_[orders.front()->getLevelHandle()];
+
+    level.erase(orders);
+    Size size = level.size_;
+
+    if (level.empty())
+    {
+      erase(find(level.price_));
+    }
+    return size;
+  }
+
+  Size reduce(OrderPointer order, Size size)
+  {
+    auto &level = levels_[order->getLevelHandle()];
+    level.reduce(order, size);
+    return level.size_;
+  }
+
+  void snapshot(std::size_t count, auto &&onLevel) const
+  {
+    for (auto cursor = best(); cursor.chunk_ != npos && count > 0;
+         cursor = next(cursor), --count)
+    {
+      onLevel(at(cursor).price_, at(cursor).size_);
+    }
+  }
+
+  void visit(auto &&onLevel) const
+  {
+    for (auto cursor = best(); cursor.chunk_ != npos; cursor = next(cursor))
+    {
+      onLevel(at(cursor));
+    }
+  }
+
+  /**
+   * @brief Fills an empty container with levels, given best first
+   */
+  void restore(std::vector<Level> levels)
+  {
+    for (auto level = levels.rbegin(); level != levels.rend(); ++level)
+    {
+      if (empty() || chunks_.back().size_ == ChunkLevels)
+      {
+        chunks_.emplace_back();
+      }
+
+      auto &chunk = chunks_.back();
+      auto handle = levels_.acquire(std::move(*level));
+      levels_[handle].setHandle(handle);
+
+      chunk.prices_[chunk.size_] = levels_[handle].price_;
+      chunk.handles_[chunk.size_] = handle;
+      ++chunk.size_;
+    }
+  }
+
+  iterator begin() { return iterator{this, best()}; }
+
+  iterator end() { return iterator{}; }
+
+  const_iterator begin() const { return const_iterator{this, best()}; }
+
+  const_iterator end() const { return const_iterator{}; }
+
+private:
+  // Whether a has lower priority than b
+  bool worse(Price a, Price b) const { return comp_(b, a); }
+
+  Level &at(Cursor cursor)
+  {
+    return levels_[chunks_[cursor.chunk_].handles_[cursor.slot_]];
+  }
+
+  const Level &at(Cursor cursor) const
+  {
+    return levels_[chunks_[cursor.chunk_].handles_[cursor.slot_]];
+  }
+
+  Cursor best() const
+  {
+    if (empty())
+      return Cursor{npos, 0};
+
+    return Cursor{chunks_.size() - 1, chunks_.back().size_ - 1};
+  }
+
+  /**
+   * @brief The level after cursor in priority order
+   */
+  Cursor next(Cursor cursor) const
+  {
+    if (cursor.slot_ > 0)
+      return Cursor{cursor.chunk_, cursor.slot_ - 1};
+
+    if (cursor.chunk_ == 0)
+      return Cursor{npos, 0};
+
+    return Cursor{cursor.chunk_ - 1, chunks_[cursor.chunk_ - 1].size_ - 1};
+  }
+
+  /**
+   * @brief Where price is, or would be inserted, in a non-empty container
+   *
+   * @details Picks the last chunk whose worst price is no better than
+   *          price, or the first chunk, then scans its prices.
+   */
+  Cursor find(Price price) const
+  {
+    auto it = std::upper_bound(chunks_.begin(), chunks_.end(), price,
+                               [&](Price key, const Chunk &chunk)
+                               { return worse(key, chunk.prices_[0]); });
+    auto c = it == chunks_.begin()
+                 ? 0
+                 : static_cast<std::size_t>(it - chunks_.begin()) - 1;
+
+    const auto &chunk = chunks_[c];
+    std::size_t slot = 0;
+    while (slot < chunk.size_ && worse(chunk.prices_[slot], price))
+    {
+      ++slot;
+    }
+    return Cursor{c, slot};
+  }
+
+  /**
+   * @brief Creates the level for price at cursor, splitting a full chunk
+   *
+   * @return the new level's handle
+   */
+  std::uint32_t insert(Cursor cursor, Price price)
+  {
+    constexpr std::size_t half = ChunkLevels / 2;
+
+    if (chunks_[cursor.chunk_].size_ == ChunkLevels)
+    {
+      chunks_.emplace(chunks_.begin() + cursor.chunk_ + 1);
+
+      auto &full = chunks_[cursor.chunk_];
+      auto &upper = chunks_[cursor.chunk_ + 1];
+      std::copy(full.prices_.begin() + half, full.prices_.end(),
+                upper.prices_.begin());
+      std::copy(full.handles_.begin() + half, full.handles_.end(),
+                upper.handles_.begin());
+      upper.size_ = ChunkLevels - half;
+      full.size_ = half;
+
+      if (cursor.slot_ > half)
+      {
+        ++cursor.chunk_;
+        cursor.slot_ -= half;
+      }
+    }
+
+    auto &chunk = chunks_[cursor.chunk_];
+    auto slot = cursor.slot_;
+    std::copy_backward(chunk.prices_.begin() + slot,
+                       chunk.prices_.begin() + chunk.size_,
+                       chunk.prices_.begin() + chunk.size_ + 1);
+    std::copy_backward(chunk.handles_.begin() + slot,
+                       chunk.handles_.begin() + chunk.size_,
+                       chunk.handles_.begin() + chunk.size_ + 1);
+
+    auto handle = levels_.acquire(Level{price});
+    levels_[handle].handle_ = handle;
+
+    chunk.prices_[slot] = price;
+    chunk.handles_[slot] = handle;
+    ++chunk.size_;
+    return handle;
+  }
+
+  /**
+   * @brief Drops the level at cursor, merging its chunk with the one before
+   *        or after when both fit in half a chunk
+   *
+   * @details Merging with either neighbour keeps every two neighbouring
+   *          chunks over half a chunk between them, so there are at most
+   *          two chunks for every ChunkLevels / 2 + 1 levels, plus one,
+   *          wherever levels leave from.
+   *
+   * @return the level that followed it in priority order
+   */
+  Cursor erase(Cursor cursor)
+  {
+    auto c = cursor.chunk_;
+    auto &chunk = chunks_[c];
+    levels_.release(chunk.handles_[cursor.slot_]);
+
+    std::copy(chunk.prices_.begin() + cursor.slot_ + 1,
+              chunk.prices_.begin() + chunk.size_,
+              chunk.prices_.begin() + cursor.slot_);
+    std::copy(chunk.handles_.begin() + cursor.slot_ + 1,
+              chunk.handles_.begin() + chunk.size_,
+              chunk.handles_.begin() + cursor.slot_);
+    --chunk.size_;
+
+    auto following = next(cursor);
+
+    if (c > 0 && fits(c - 1))
+    {
+      if (following.chunk_ == c)
+      {
+        following = Cursor{c - 1, chunks_[c - 1].size_ + following.slot_};
+      }
+      merge(c - 1);
+      --c;
+    }
+    else if (chunk.size_ == 0)
+    {
+      chunks_.erase(chunks_.begin() + c);
+      return following;
+    }
+
+    // The level following sits at or before chunk c, so stays put
+    if (c + 1 < chunks_.size() && fits(c))
+    {
+      merge(c);
+    }
+
+    return following;
+  }
+
+  /**
+   * @brief Whether chunk c and the one after fit in half a chunk
+   */
+  bool fits(std::size_t c) const
+  {
+    return chunks_[c].size_ + chunks_[c + 1].size_ <= ChunkLevels / 2;
+  }
+
+  /**
+   * @brief Moves the chunk after c onto the end of c
+   */
+  void merge(std::size_t c)
+  {
+    auto &lower = chunks_[c];
+    auto &upper = chunks_[c + 1];
+    std::copy(upper.prices_.begin(), upper.prices_.begin() + upper.size_,
+              lower.prices_.begin() + lower.size_);
+    std::copy(upper.handles_.begin(), upper.handles_.begin() + upper.size_,
+              lower.handles_.begin() + lower.size_);
+    lower.size_ += upper.size_;
+    chunks_.erase(chunks_.begin() + c + 1);
+  }
+
+  // Ordered worst first
+  std::vector<Chunk> chunks_;
+  SlotTable<Level> levels_;
+  Compare comp_;
+};
+
+template <typename Compare, typename OrderContainer>
+using ChunkedLevelPolicy = BasicChunkedLevelPolicy<Compare, OrderContainer>;
@@ -1,6 +1,6 @@
 #pragma once
 
-#include <memory>
+#include <cstdint>
 
 #include "orderbook/types.h"
 
@@ -9,30 +9,66 @@ class Order
 public:
   Order(OrderType orderType, OrderId orderId, Side side, Price price,
         Size volume)
-      : orderType_{orderType}, orderId_{orderId}, side_{side}, price_{price},
-        volume_{volume}, remaining_{volume}
+      : orderType_{static_cast<std::uint8_t>(orderType)},
+        side_{static_cast<std::uint8_t>(side)}, orderId_{orderId},
+        price_{price}, volume_{volume}, remaining_{volume}
   {
   }
 
-  OrderType getOrderType() const { return orderType_; }
+  OrderType getOrderType() const { return static_cast<OrderType>(orderType_); }
   OrderId getOrderId() const { return orderId_; }
-  Side getSide() const { return side_; }
+  Side getSide() const { return static_cast<Side>(side_); }
   Price getPrice() const { return price_; }
   Size getInitialSize() const { return volume_; }
   Size getRemainingSize() const { return remaining_; }
   Size filledAmount() const { return volume_ - remaining_; }
 
+  // Handle to the level holding this order, given out by its level container
+  std::uint32_t getLevelHandle() const { return level_; }
+
   bool isFilled() const { return remaining_ == 0; }
 
   void fill(const Size &size) { remaining_ -= size; }
 
+  // Amends the order down by size, leaving what has filled untouched
+  void reduce(const Size &size)
+  {
+    volume_ -= size;
+    remaining_ -= size;
+  }
+
 private:
-  OrderType orderType_;
+  friend class AllOrNoneQueue;
+  friend struct ListOrderPolicy;
+  friend struct IntrusiveOrderPolicy;
+  friend struct ColumnarOrderPolicy;
+  template <typename> friend struct TombstoneOrderPolicy;
+  template <typename> friend struct PriceLevel;
+
+  // Stored as bytes so the fields below share one word with them and the
+  // order stays 64 bytes
+  std::uint8_t orderType_;
+  std::uint8_t side_;
+
+  // Queue slot owned by the order container: ListOrderPolicy,
+  // ColumnarOrderPolicy or TombstoneOrderPolicy, or by AllOrNoneQueue for
+  // AllOrNone orders
+  std::uint32_t slot_{};
+
+  // Arrival order within its level, set by PriceLevel
+  std::uint32_t sequence_{};
+
+  // Level handle, set by PriceLevel when the order joins it
+  std::uint32_t level_{};
+
   OrderId orderId_;
-  Side side_;
   Price price_;
   Size volume_;
   Size remaining_;
+
+  // Queue links owned by IntrusiveOrderPolicy
+  Order *prev_{};
+  Order *next_{};
 };
 
-using OrderPointer = std::shared_ptr<Order>;
+using OrderPointer = Order *;
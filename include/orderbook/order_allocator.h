@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <vector>
+
+#include "orderbook/order.h"
+#include "orderbook/types.h"
+
+/**
+ * @brief Allocates every resting Order individually on the heap
+ */
+struct HeapOrderAllocator
+{
+  OrderPointer allocate(OrderType orderType, OrderId orderId, Side side,
+                        Price price, Size volume)
+  {
+    return new Order(orderType, orderId, side, price, volume);
+  }
+
+  void deallocate(OrderPointer order) { delete order; }
+
+  void reserve(std::size_t) {}
+};
+
+/**
+ * @brief Hands out Order%s from fixed-size slabs
+ *
+ * @details Released slots go onto an intrusive free list and are reused
+ *          LIFO, so the most recently touched memory is handed out first.
+ *          Slabs are only released when the allocator is destroyed, which
+ *          keeps every OrderPointer stable while the order is alive.
+ */
+class PoolOrderAllocator
+{
+public:
+  explicit PoolOrderAllocator(std::size_t slabSize = 4096)
+      : slabs_{}, free_{}, slabSize_{slabSize}
+  {
+  }
+
+  PoolOrderAllocator(const PoolOrderAllocator &) = delete;
+  PoolOrderAllocator &operator=(const PoolOrderAllocator &) = delete;
+
+  OrderPointer allocate(OrderType orderType, OrderId orderId, Side side,
+                        Price price, Size volume)
+  {
+    if (!free_)
+    {
+      grow();
+    }
+
+    Slot *slot = free_;
+    free_ = slot->next_;
+    return new (slot->storage_) Order(orderType, orderId, side, price, volume);
+  }
+
+  void deallocate(OrderPointer order)
+  {
+    order->~Order();
+    auto *slot = reinterpret_cast<Slot *>(order);
+    slot->next_ = free_;
+    free_ = slot;
+  }
+
+  /**
+   * @brief Grows the pool until at least count orders fit without a new slab
+   */
+  void reserve(std::size_t count)
+  {
+    std::size_t available = 0;
+    for (Slot *slot = free_; slot; slot = slot->next_)
+    {
+      ++available;
+    }
+
+    while (available < count)
+    {
+      grow();
+      available += slabSize_;
+    }
+  }
+
+private:
+  union Slot
+  {
+    Slot *next_;
+    alignas(Order) std::byte storage_[sizeof(Order)];
+  };
+
+  void grow()
+  {
+    auto slab = std::make_unique<Slot[]>(slabSize_);
+
+    // Thread in reverse so the slab is handed out front to back
+    for (std::size_t i = slabSize_; i-- > 0;)
+    {
+      slab[i].next_ = free_;
+      free_ = &slab[i];
+    }
+
+    slabs_.push_back(std::move(slab));
+  }
+
+  std::vector<std::unique_ptr<Slot[]>> slabs_;
+  Slot *free_;
+  std::size_t slabSize_;
+};
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "orderbook/types.h"
+
+enum class OrderEventType : std::uint8_t
+{
+  Add,
+  Execute,
+  Reduce,
+  Delete,
+};
+
+/**
+ * @brief Fixed-size market-by-order record
+ *
+ * @details Add carries the resting volume, Execute and Reduce the volume
+ *          taken off the order, Delete the volume that was still resting.
+ */
+struct OrderEvent
+{
+  OrderEventType type_;
+  Side side_;
+  OrderId orderId_;
+  Price price_;
+  Size size_;
+};
+
+/**
+ * @brief Order event listener that ignores every event
+ */
+struct NullOrderEventListener
+{
+  void onEvent(const OrderEvent &) {}
+};
+
+/**
+ * @brief Order event listener writing into storage allocated up front
+ *
+ * @details Events beyond capacity are counted but dropped, so the caller can
+ *          detect overflow with overflowed(). Recording never allocates.
+ */
+class OrderEventBuffer
+{
+public:
+  explicit OrderEventBuffer(std::size_t capacity = 4096)
+      : storage_(capacity), count_{}
+  {
+  }
+
+  void onEvent(const OrderEvent &event)
+  {
+    if (count_ < storage_.size())
+    {
+      storage_[count_] = event;
+    }
+    ++count_;
+  }
+
+  std::span<const OrderEvent> events() const
+  {
+    return std::span<const OrderEvent>{storage_}.first(
+        std::min(count_, storage_.size()));
+  }
+
+  std::size_t count() const { return count_; }
+  bool overflowed() const { return count_ > storage_.size(); }
+  void clear() { count_ = 0; }
+
+private:
+  std::vector<OrderEvent> storage_;
+  std::size_t count_;
+};
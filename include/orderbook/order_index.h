@@ -0,0 +1,297 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include "orderbook/order.h"
+#include "orderbook/types.h"
+
+/**
+ * @brief Open-addressing hash map from OrderId to Value
+ *
+ * @details Robin Hood linear probing over a power-of-two table. Probe
+ *          distances live in a separate byte array so lookups scan a compact
+ *          run of metadata before touching a slot. Erase shifts the
+ *          following run back by one slot instead of leaving tombstones, so
+ *          lookups never slow down after heavy cancel traffic.
+ *
+ * @tparam Value    the mapped type, must be default constructible
+ */
+template <typename Value> class FlatOrderMap
+{
+public:
+  using key_type = OrderId;
+  using mapped_type = Value;
+  using value_type = std::pair<OrderId, Value>;
+
+  template <typename Map, typename Entry> class basic_iterator
+  {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = FlatOrderMap::value_type;
+    using difference_type = std::ptrdiff_t;
+    using pointer = Entry *;
+    using reference = Entry &;
+
+    basic_iterator() : map_{}, index_{} {}
+    basic_iterator(Map *map, std::size_t index) : map_{map}, index_{index}
+    {
+      skipEmpty();
+    }
+
+    reference operator*() const { return map_->slots_[index_]; }
+    pointer operator->() const { return &map_->slots_[index_]; }
+
+    basic_iterator &operator++()
+    {
+      ++index_;
+      skipEmpty();
+      return *this;
+    }
+
+    basic_iterator operator++(int)
+    {
+      auto prev = *this;
+      ++*this;
+      return prev;
+    }
+
+    bool operator==(const basic_iterator &other) const
+    {
+      return index_ == other.index_;
+    }
+
+  private:
+    friend class FlatOrderMap;
+
+    void skipEmpty()
+    {
+      while (index_ < map_->distances_.size() && map_->distances_[index_] == 0)
+      {
+        ++index_;
+      }
+    }
+
+    Map *map_;
+    std::size_t index_;
+  };
+
+  using iterator = basic_iterator<FlatOrderMap, value_type>;
+  using const_iterator = basic_iterator<const FlatOrderMap, const value_type>;
+
+  FlatOrderMap() : slots_{}, distances_{}, size_{}, shift_{64} {}
+
+  bool empty() const { return size_ == 0; }
+  std::size_t size() const { return size_; }
+  std::size_t capacity() const { return slots_.size(); }
+
+  iterator begin() { return iterator{this, 0}; }
+  iterator end() { return iterator{this, slots_.size()}; }
+  const_iterator begin() const { return const_iterator{this, 0}; }
+  const_iterator end() const { return const_iterator{this, slots_.size()}; }
+
+  /**
+   * @brief Grows the table so count entries fit without rehashing
+   */
+  void reserve(std::size_t count)
+  {
+    std::size_t capacity = minCapacity_;
+    while (capacity * maxLoadNumerator_ / maxLoadDenominator_ < count)
+    {
+      capacity *= 2;
+    }
+
+    if (capacity > slots_.size())
+    {
+      rehash(capacity);
+    }
+  }
+
+  iterator find(OrderId key) { return iterator{this, locate(key)}; }
+
+  const_iterator find(OrderId key) const
+  {
+    return const_iterator{this, locate(key)};
+  }
+
+  bool contains(OrderId key) const { return locate(key) != slots_.size(); }
+
+  Value &operator[](OrderId key)
+  {
+    auto index = locate(key);
+    if (index != slots_.size())
+    {
+      return slots_[index].second;
+    }
+    return slots_[insertNew(key, Value{})].second;
+  }
+
+  std::pair<iterator, bool> try_emplace(OrderId key, Value value)
+  {
+    auto index = locate(key);
+    if (index != slots_.size())
+    {
+      return {iterator{this, index}, false};
+    }
+    return {iterator{this, insertNew(key, std::move(value))}, true};
+  }
+
+  void erase(iterator it) { eraseAt(it.index_); }
+
+  std::size_t erase(OrderId key)
+  {
+    auto index = locate(key);
+    if (index == slots_.size())
+      return 0;
+
+    eraseAt(index);
+    return 1;
+  }
+
+  void clear()
+  {
+    for (auto &distance : distances_)
+    {
+      distance = 0;
+    }
+    size_ = 0;
+  }
+
+  /**
+   * @brief Hints the slot for key into cache ahead of a lookup
+   */
+  void prefetch(OrderId key) const
+  {
+    if (!slots_.empty())
+    {
+      auto index = home(key);
+      __builtin_prefetch(&distances_[index]);
+      __builtin_prefetch(&slots_[index]);
+    }
+  }
+
+private:
+  static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+  static constexpr std::size_t minCapacity_ = 16;
+  static constexpr std::size_t maxLoadNumerator_ = 7;
+  static constexpr std::size_t maxLoadDenominator_ = 8;
+  static constexpr std::uint8_t maxDistance_ = 255;
+
+  std::size_t home(OrderId key) const
+  {
+    // Fibonacci hashing spreads sequential ids across the table
+    return static_cast<std::size_t>((key * 0x9E3779B97F4A7C15ull) >> shift_);
+  }
+
+  std::size_t mask() const { return slots_.size() - 1; }
+
+  std::size_t locate(OrderId key) const
+  {
+    if (size_ == 0)
+      return slots_.size();
+
+    auto index = home(key);
+    for (std::size_t distance = 1; distances_[index] >= distance; ++distance)
+    {
+      if (distances_[index] == distance && slots_[index].first == key)
+        return index;
+
+      index = (index + 1) & mask();
+    }
+    return slots_.size();
+  }
+
+  std::size_t insertNew(OrderId key, Value value)
+  {
+    if ((size_ + 1) * maxLoadDenominator_ > slots_.size() * maxLoadNumerator_)
+    {
+      rehash(slots_.empty() ? minCapacity_ : slots_.size() * 2);
+    }
+
+    value_type entry{key, std::move(value)};
+    std::uint8_t distance = 1;
+    auto index = home(key);
+    std::size_t placed = npos;
+
+    while (true)
+    {
+      if (distances_[index] == 0)
+      {
+        slots_[index] = std::move(entry);
+        distances_[index] = distance;
+        ++size_;
+        return placed == npos ? index : placed;
+      }
+
+      // Robin Hood: the entry further from home keeps the slot
+      if (distances_[index] < distance)
+      {
+        std::swap(slots_[index], entry);
+        std::swap(distances_[index], distance);
+
+        if (placed == npos)
+        {
+          placed = index;
+        }
+      }
+
+      if (distance == maxDistance_)
+      {
+        // Probe run too long to encode, grow and retry the displaced entry
+        rehash(slots_.size() * 2);
+        auto displaced = insertNew(entry.first, std::move(entry.second));
+        return placed == npos ? displaced : locate(key);
+      }
+
+      index = (index + 1) & mask();
+      ++distance;
+    }
+  }
+
+  void eraseAt(std::size_t index)
+  {
+    auto next = (index + 1) & mask();
+
+    // Backward shift the rest of the probe run into the hole
+    while (distances_[next] > 1)
+    {
+      slots_[index] = std::move(slots_[next]);
+      distances_[index] = distances_[next] - 1;
+      index = next;
+      next = (next + 1) & mask();
+    }
+
+    distances_[index] = 0;
+    --size_;
+  }
+
+  void rehash(std::size_t capacity)
+  {
+    auto slots = std::move(slots_);
+    auto distances = std::move(distances_);
+
+    slots_.assign(capacity, value_type{});
+    distances_.assign(capacity, 0);
+    size_ = 0;
+    shift_ = 64 - std::countr_zero(capacity);
+
+    for (std::size_t i = 0; i < slots.size(); ++i)
+    {
+      if (distances[i] != 0)
+      {
+        insertNew(slots[i].first, std::move(slots[i].second));
+      }
+    }
+  }
+
+  std::vector<value_type> slots_;
+  std::vector<std::uint8_t> distances_;
+  std::size_t size_;
+  int shift_;
+};
+
+using FlatOrderIndex = FlatOrderMap<OrderPointer>;
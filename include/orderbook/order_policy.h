@@ -1,41 +1,44 @@
 #pragma once
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <deque>
 #include <iterator>
 #include <list>
-#include <unordered_map>
 #include <vector>
 
 #include "orderbook/order.h"
+#include "orderbook/slot_table.h"
 #include "orderbook/types.h"
 
+/**
+ * @brief Orders kept in a std::list, each reaching its node through a
+ *        handle in Order::slot_
+ */
 struct ListOrderPolicy
 {
   using OrderContainer = std::list<OrderPointer>;
 
   OrderContainer orders_;
-  std::unordered_map<OrderId, OrderContainer::iterator> orderPosition_;
+  SlotTable<OrderContainer::iterator> positions_;
 
-  ListOrderPolicy() : orders_{}, orderPosition_{} {}
+  ListOrderPolicy() : orders_{}, positions_{} {}
 
   void insert(OrderPointer order)
   {
-    orderPosition_[order->getOrderId()] = orders_.insert(orders_.end(), order);
+    order->slot_ = positions_.acquire(orders_.insert(orders_.end(), order));
   }
 
   OrderContainer::iterator erase(OrderContainer::iterator it)
   {
-    auto order = *it;
-    auto next = orders_.erase(it);
-    orderPosition_.erase(order->getOrderId());
-    return next;
+    positions_.release((*it)->slot_);
+    return orders_.erase(it);
   }
 
   OrderContainer::iterator erase(OrderPointer order)
   {
-    auto next = orders_.erase(orderPosition_[order->getOrderId()]);
-    orderPosition_.erase(order->getOrderId());
-    return next;
+    return erase(positions_[order->slot_]);
   }
 
   auto size() const { return orders_.size(); }
@@ -74,11 +77,16 @@ struct DequeOrderPolicy
                          orders_.end());
   }
 
+  /**
+   * @brief Erases every order pred holds for in one pass
+   */
+  void eraseIf(auto &&pred) { std::erase_if(orders_, pred); }
+
   auto size() const { return orders_.size(); }
 
   OrderPointer front() { return orders_.front(); }
 
-  bool empty() { return orders_.empty(); }
+  bool empty() const { return orders_.empty(); }
 
   OrderContainer::iterator begin() { return orders_.begin(); }
 
@@ -110,11 +118,16 @@ struct VectorOrderPolicy
                          orders_.end());
   }
 
+  /**
+   * @brief Erases every order pred holds for in one pass
+   */
+  void eraseIf(auto &&pred) { std::erase_if(orders_, pred); }
+
   auto size() const { return orders_.size(); }
 
   OrderPointer front() { return orders_.front(); }
 
-  bool empty() { return orders_.empty(); }
+  bool empty() const { return orders_.empty(); }
 
   OrderContainer::iterator begin() { return orders_.begin(); }
 
@@ -124,3 +137,489 @@ struct VectorOrderPolicy
 
   OrderContainer::const_iterator end() const { return orders_.end(); }
 };
+
+/**
+ * @brief Orders are kept in an intrusive doubly-linked list
+ *
+ * @details Queue links live inside the Order itself, so insert and erase are
+ *          O(1) and never allocate. The book must keep each Order alive for
+ *          as long as it is queued.
+ */
+struct IntrusiveOrderPolicy
+{
+  class iterator
+  {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = Order *;
+    using difference_type = std::ptrdiff_t;
+    using pointer = Order *const *;
+    using reference = Order *const &;
+
+    iterator() : order_{} {}
+    explicit iterator(Order *order) : order_{order} {}
+
+    reference operator*() const { return order_; }
+    pointer operator->() const { return &order_; }
+
+    iterator &operator++()
+    {
+      order_ = order_->next_;
+      return *this;
+    }
+
+    iterator operator++(int)
+    {
+      auto prev = *this;
+      ++*this;
+      return prev;
+    }
+
+    bool operator==(const iterator &) const = default;
+
+  private:
+    Order *order_;
+  };
+
+  using const_iterator = iterator;
+
+  Order *head_;
+  Order *tail_;
+  std::size_t size_;
+
+  IntrusiveOrderPolicy() : head_{}, tail_{}, size_{} {}
+
+  void insert(OrderPointer order)
+  {
+    Order *node = order;
+    node->prev_ = tail_;
+    node->next_ = nullptr;
+
+    if (tail_)
+    {
+      tail_->next_ = node;
+    }
+    else
+    {
+      head_ = node;
+    }
+    tail_ = node;
+    ++size_;
+  }
+
+  iterator erase(iterator it) { return iterator{unlink(*it)}; }
+
+  iterator erase(OrderPointer order) { return iterator{unlink(order)}; }
+
+  auto size() const { return size_; }
+
+  Order *front() const { return head_; }
+
+  bool empty() const { return head_ == nullptr; }
+
+  iterator begin() const { return iterator{head_}; }
+
+  iterator end() const { return iterator{}; }
+
+private:
+  Order *unlink(Order *node)
+  {
+    Order *next = node->next_;
+
+    if (node->prev_)
+    {
+      node->prev_->next_ = next;
+    }
+    else
+    {
+      head_ = next;
+    }
+
+    if (next)
+    {
+      next->prev_ = node->prev_;
+    }
+    else
+    {
+      tail_ = node->prev_;
+    }
+
+    node->prev_ = nullptr;
+    node->next_ = nullptr;
+    --size_;
+    return next;
+  }
+};
+
+/**
+ * @brief Orders are kept in Container, with erased orders left behind as
+ *        tombstones
+ *
+ * @details Each Order remembers its slot, so erase clears that slot in O(1)
+ *          instead of searching the level and shifting everything behind
+ *          it. Iteration skips tombstones. Once they outnumber the live
+ *          orders, the erase by order that tips them over, or else the next
+ *          insert, compacts the level in one pass, and a level that has
+ *          emptied is reset. Erasing through an iterator never compacts,
+ *          so a sweep's position stays valid.
+ *
+ * @tparam Container    std::deque or std::vector of OrderPointer
+ */
+template <typename Container> struct TombstoneOrderPolicy
+{
+  /**
+   * @brief Walks the live orders in time priority, skipping tombstones
+   */
+  class iterator
+  {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = Order *;
+    using difference_type = std::ptrdiff_t;
+    using pointer = Order *const *;
+    using reference = Order *const &;
+
+    iterator() : orders_{}, slot_{} {}
+    iterator(const TombstoneOrderPolicy *orders, std::size_t slot)
+        : orders_{orders}, slot_{orders->skip(slot)}
+    {
+    }
+
+    reference operator*() const { return orders_->orders_[slot_]; }
+    pointer operator->() const { return &orders_->orders_[slot_]; }
+
+    iterator &operator++()
+    {
+      slot_ = orders_->skip(slot_ + 1);
+      return *this;
+    }
+
+    iterator operator++(int)
+    {
+      auto prev = *this;
+      ++*this;
+      return prev;
+    }
+
+    bool operator==(const iterator &other) const
+    {
+      return slot_ == other.slot_;
+    }
+
+  private:
+    friend struct TombstoneOrderPolicy;
+
+    const TombstoneOrderPolicy *orders_;
+    std::size_t slot_;
+  };
+
+  using const_iterator = iterator;
+
+  Container orders_;
+
+  // Every slot before head_ is a tombstone
+  std::size_t head_;
+  std::size_t live_;
+
+  TombstoneOrderPolicy() : orders_{}, head_{}, live_{} {}
+
+  void insert(OrderPointer order)
+  {
+    if (live_ == 0)
+    {
+      orders_.clear();
+      head_ = 0;
+    }
+    else if (orders_.size() - live_ > live_)
+    {
+      compact();
+    }
+
+    order->slot_ = static_cast<std::uint32_t>(orders_.size());
+    orders_.push_back(order);
+    ++live_;
+  }
+
+  iterator erase(iterator it)
+  {
+    eraseSlot(it.slot_);
+    return iterator{this, it.slot_ + 1};
+  }
+
+  iterator erase(OrderPointer order)
+  {
+    std::size_t slot = order->slot_;
+    eraseSlot(slot);
+    if (orders_.size() - live_ <= live_)
+      return iterator{this, slot + 1};
+
+    // Compacting moves the next live order, so find it again by its slot
+    auto next = skip(slot + 1);
+    auto nextOrder = next < orders_.size() ? orders_[next] : nullptr;
+    compact();
+    return nextOrder ? iterator{this, nextOrder->slot_} : end();
+  }
+
+  auto size() const { return live_; }
+
+  OrderPointer front() const { return orders_[head_]; }
+
+  bool empty() const { return live_ == 0; }
+
+  iterator begin() const { return iterator{this, head_}; }
+
+  iterator end() const { return iterator{this, orders_.size()}; }
+
+private:
+  void eraseSlot(std::size_t slot)
+  {
+    orders_[slot] = nullptr;
+    --live_;
+    head_ = skip(head_);
+  }
+
+  std::size_t skip(std::size_t slot) const
+  {
+    while (slot < orders_.size() && orders_[slot] == nullptr)
+    {
+      ++slot;
+    }
+    return slot;
+  }
+
+  void compact()
+  {
+    std::size_t to = 0;
+    for (std::size_t from = head_; from < orders_.size(); ++from)
+    {
+      if (orders_[from] == nullptr)
+        continue;
+
+      orders_[to] = orders_[from];
+      orders_[to]->slot_ = static_cast<std::uint32_t>(to);
+      ++to;
+    }
+
+    orders_.resize(to);
+    head_ = 0;
+  }
+};
+
+using TombstoneDequeOrderPolicy =
+    TombstoneOrderPolicy<std::deque<OrderPointer>>;
+using TombstoneVectorOrderPolicy =
+    TombstoneOrderPolicy<std::vector<OrderPointer>>;
+
+/**
+ * @brief Orders are kept as parallel arrays of ids and remaining sizes, one
+ *        slot per order
+ *
+ * @details A level scan reads sizes from a contiguous array and only
+ *          touches an Order when it trades. Each slot also keeps its
+ *          order's arrival stamp, so the queue ahead of a given arrival is
+ *          found by binary search and summed straight from the sizes.
+ *          Erased orders are left behind as tombstones with no remaining
+ *          size and are compacted away once they outnumber the live orders,
+ *          by the erase by order that tips them over or else the next
+ *          insert. Erasing a slot or through an iterator never compacts, so
+ *          a sweep's slot stays valid. Each Order remembers its slot, so
+ *          erase is O(1).
+ */
+struct ColumnarOrderPolicy
+{
+  /**
+   * @brief Walks the live orders in time priority, skipping tombstones
+   */
+  class iterator
+  {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = Order *;
+    using difference_type = std::ptrdiff_t;
+    using pointer = Order *const *;
+    using reference = Order *const &;
+
+    iterator() : orders_{}, slot_{} {}
+    iterator(const ColumnarOrderPolicy *orders, std::size_t slot)
+        : orders_{orders}, slot_{orders->skip(slot)}
+    {
+    }
+
+    reference operator*() const { return orders_->orders_[slot_]; }
+    pointer operator->() const { return &orders_->orders_[slot_]; }
+
+    iterator &operator++()
+    {
+      slot_ = orders_->skip(slot_ + 1);
+      return *this;
+    }
+
+    iterator operator++(int)
+    {
+      auto prev = *this;
+      ++*this;
+      return prev;
+    }
+
+    bool operator==(const iterator &other) const
+    {
+      return slot_ == other.slot_;
+    }
+
+  private:
+    friend struct ColumnarOrderPolicy;
+
+    const ColumnarOrderPolicy *orders_;
+    std::size_t slot_;
+  };
+
+  using const_iterator = iterator;
+
+  std::vector<OrderPointer> orders_;
+  std::vector<OrderId> ids_;
+  std::vector<Size> remaining_;
+  std::vector<std::uint32_t> sequences_;
+
+  // Every slot before head_ is a tombstone
+  std::size_t head_;
+  std::size_t live_;
+
+  ColumnarOrderPolicy()
+      : orders_{}, ids_{}, remaining_{}, sequences_{}, head_{}, live_{}
+  {
+  }
+
+  void insert(OrderPointer order)
+  {
+    if (live_ == 0)
+    {
+      clear();
+    }
+    else if (orders_.size() - live_ > live_)
+    {
+      compact();
+    }
+
+    order->slot_ = static_cast<std::uint32_t>(orders_.size());
+    orders_.push_back(order);
+    ids_.push_back(order->getOrderId());
+    remaining_.push_back(order->getRemainingSize());
+    sequences_.push_back(order->sequence_);
+    ++live_;
+  }
+
+  iterator erase(iterator it)
+  {
+    eraseSlot(it.slot_);
+    return iterator{this, it.slot_ + 1};
+  }
+
+  iterator erase(OrderPointer order)
+  {
+    std::size_t slot = order->slot_;
+    eraseSlot(slot);
+    if (orders_.size() - live_ <= live_)
+      return iterator{this, slot + 1};
+
+    // Compacting moves the next live order, so find it again by its slot
+    auto next = skip(slot + 1);
+    auto nextOrder = next < orders_.size() ? orders_[next] : nullptr;
+    compact();
+    return nextOrder ? iterator{this, nextOrder->slot_} : end();
+  }
+
+  auto size() const { return live_; }
+
+  OrderPointer front() const { return orders_[head_]; }
+
+  bool empty() const { return live_ == 0; }
+
+  iterator begin() const { return iterator{this, head_}; }
+
+  iterator end() const { return iterator{this, orders_.size()}; }
+
+  /**
+   * @brief Slots [firstSlot(), lastSlot()) hold every live order, in time
+   *        priority, among tombstones whose remaining() is zero
+   */
+  std::size_t firstSlot() const { return head_; }
+  std::size_t lastSlot() const { return orders_.size(); }
+
+  OrderPointer order(std::size_t slot) const { return orders_[slot]; }
+  OrderId id(std::size_t slot) const { return ids_[slot]; }
+  Size remaining(std::size_t slot) const { return remaining_[slot]; }
+  std::uint32_t sequence(std::size_t slot) const { return sequences_[slot]; }
+
+  /**
+   * @brief Remaining sizes of every slot, tombstones included as zero
+   */
+  const Size *remainingSizes() const { return remaining_.data(); }
+
+  /**
+   * @brief Fills the order in slot, returning true once nothing remains
+   */
+  bool fill(std::size_t slot, Size size)
+  {
+    remaining_[slot] -= size;
+    orders_[slot]->fill(size);
+    return remaining_[slot] == 0;
+  }
+
+  void reduce(OrderPointer order, Size size)
+  {
+    remaining_[order->slot_] -= size;
+    order->reduce(size);
+  }
+
+  /**
+   * @brief Leaves a tombstone in slot without moving the arrays
+   */
+  void eraseSlot(std::size_t slot)
+  {
+    remaining_[slot] = 0;
+    --live_;
+    head_ = skip(head_);
+  }
+
+private:
+  std::size_t skip(std::size_t slot) const
+  {
+    while (slot < remaining_.size() && remaining_[slot] == 0)
+    {
+      ++slot;
+    }
+    return slot;
+  }
+
+  void clear()
+  {
+    orders_.clear();
+    ids_.clear();
+    remaining_.clear();
+    sequences_.clear();
+    head_ = 0;
+  }
+
+  void compact()
+  {
+    std::size_t to = 0;
+    for (std::size_t from = head_; from < orders_.size(); ++from)
+    {
+      if (remaining_[from] == 0)
+        continue;
+
+      orders_[to] = orders_[from];
+      ids_[to] = ids_[from];
+      remaining_[to] = remaining_[from];
+      sequences_[to] = sequences_[from];
+      orders_[to]->slot_ = static_cast<std::uint32_t>(to);
+      ++to;
+    }
+
+    orders_.resize(to);
+    ids_.resize(to);
+    remaining_.resize(to);
+    sequences_.resize(to);
+    head_ = 0;
+  }
+};
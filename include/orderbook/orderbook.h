@@ -1,44 +1,242 @@
 #pragma once
 
 #include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <memory>
+#include <span>
+#include <stdexcept>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
+#include "orderbook/command.h"
+#include "orderbook/depth_feed.h"
+#include "orderbook/expiry_index.h"
+#include "orderbook/journal.h"
+#include "orderbook/latency.h"
 #include "orderbook/level_policy.h"
 #include "orderbook/order.h"
+#include "orderbook/order_allocator.h"
+#include "orderbook/order_event.h"
+#include "orderbook/order_index.h"
+#include "orderbook/snapshot.h"
 #include "orderbook/trade.h"
 #include "orderbook/types.h"
 
 /*
  * @tparam LevelContainer   container used to store PriceLevel%s
  * @tparam OrderContainer   container used to store Order%s as OrderPointer%s
+ * @tparam OrderAllocator   allocator that owns resting Order%s
+ * @tparam OrderIndex       map from OrderId to resting OrderPointer
+ * @tparam DepthListener    told the new volume of every level that changes
+ * @tparam OrderEventListener   told every add, execution and removal of a
+ *                              resting order
+ * @tparam Journal          records every accepted add, cancel and modify
+ * @tparam LatencyRecorder  times every add, cancel and modify call
+ * @tparam AllowAllOrNone   false for books that never rest AllOrNone orders;
+ *                          they are then rejected and matching is compiled
+ *                          without the AllOrNone checks
  */
 template <template <typename, typename> class LevelContainer,
-          typename OrderContainer>
+          typename OrderContainer,
+          typename OrderAllocator = HeapOrderAllocator,
+          typename OrderIndex = std::unordered_map<OrderId, OrderPointer>,
+          typename DepthListener = NullDepthListener,
+          typename OrderEventListener = NullOrderEventListener,
+          typename Journal = NullJournal,
+          typename LatencyRecorder = NullLatencyRecorder,
+          bool AllowAllOrNone = true>
 class OrderBook
 {
 public:
-  OrderBook() : bidLevels_{}, askLevels_{}, existingOrders_{} {}
+  OrderBook()
+      : bidLevels_{}, askLevels_{}, existingOrders_{}, allocator_{}, depth_{},
+        events_{}, journal_{}, latency_{}, expiries_{},
+        sessionClose_{noExpiry_}, cancelled_{}
+  {
+  }
+
+  explicit OrderBook(DepthListener depth, OrderEventListener events = {},
+                     Journal journal = {}, LatencyRecorder latency = {})
+      : bidLevels_{}, askLevels_{}, existingOrders_{}, allocator_{},
+        depth_{std::move(depth)}, events_{std::move(events)},
+        journal_{std::move(journal)}, latency_{std::move(latency)},
+        expiries_{}, sessionClose_{noExpiry_}, cancelled_{}
+  {
+  }
+
+  OrderBook(const OrderBook &) = delete;
+  OrderBook &operator=(const OrderBook &) = delete;
+
+  ~OrderBook()
+  {
+    for (auto &[orderId, order] : existingOrders_)
+    {
+      allocator_.deallocate(order);
+    }
+  }
+
+  /**
+   * @brief Sizes the order index and allocator for count resting orders
+   */
+  void reserve(std::size_t count)
+  {
+    existingOrders_.reserve(count);
+    allocator_.reserve(count);
+  }
 
   bool empty() const
   {
     return bidLevels_.empty() && askLevels_.empty() && existingOrders_.empty();
   }
 
+  DepthListener &depthListener() { return depth_; }
+  const DepthListener &depthListener() const { return depth_; }
+
+  OrderEventListener &orderEventListener() { return events_; }
+  const OrderEventListener &orderEventListener() const { return events_; }
+
+  Journal &journal() { return journal_; }
+  const Journal &journal() const { return journal_; }
+
+  LatencyRecorder &latencyRecorder() { return latency_; }
+  const LatencyRecorder &latencyRecorder() const { return latency_; }
+
+  /**
+   * @brief Passes the price and volume of up to count best levels on side
+   *        to onLevel, best first
+   */
+  void snapshotDepth(Side side, std::size_t count, auto &&onLevel) const
+  {
+    if (side == Side::Buy)
+    {
+      bidLevels_.snapshot(count, onLevel);
+    }
+    else
+    {
+      askLevels_.snapshot(count, onLevel);
+    }
+  }
+
+  /**
+   * @brief Serialises every resting order, level by level in time priority
+   *
+   * @details The layout is described by SnapshotFormat. The buffer is sized
+   *          exactly before anything is written.
+   */
+  std::vector<std::byte> snapshot() const
+  {
+    std::uint32_t bidCount = 0;
+    std::uint32_t askCount = 0;
+    bidLevels_.visit([&](const Level &) { ++bidCount; });
+    askLevels_.visit([&](const Level &) { ++askCount; });
+
+    std::vector<std::byte> buffer(
+        SnapshotFormat::headerSize_ +
+        (bidCount + askCount) * SnapshotFormat::levelSize_ +
+        existingOrders_.size() * SnapshotFormat::orderSize_);
+
+    SnapshotWriter writer{buffer};
+    writer.write(SnapshotFormat::magic_);
+    writer.write(SnapshotFormat::version_);
+    writer.write(bidCount);
+    writer.write(askCount);
+    writer.write(static_cast<std::uint64_t>(existingOrders_.size()));
+
+    auto writeLevel = [&](const Level &level)
+    {
+      writer.write(level.price_);
+      writer.write(static_cast<std::uint32_t>(level.count()));
+      level.visit(
+          [&](OrderPointer order)
+          {
+            writer.write(order->getOrderId());
+            writer.write(order->getRemainingSize());
+            writer.write(static_cast<std::uint8_t>(order->getOrderType()));
+          });
+    };
+    bidLevels_.visit(writeLevel);
+    askLevels_.visit(writeLevel);
+
+    return buffer;
+  }
+
+  /**
+   * @brief Rebuilds an empty book from the output of snapshot()
+   *
+   * @details Orders are queued straight onto their level and each side's
+   *          levels are handed to the level container in one go, so no
+   *          price lookup or matching happens per order. Listeners and the
+   *          journal are not told about restored orders. Restored
+   *          GoodForDay orders expire at the current session close.
+   */
+  void restore(std::span<const std::byte> snapshot)
+  {
+    if (!empty())
+    {
+      throw std::runtime_error("Book is not empty");
+    }
+
+    SnapshotReader reader{snapshot};
+    if (reader.read<std::uint64_t>() != SnapshotFormat::magic_ ||
+        reader.read<std::uint32_t>() != SnapshotFormat::version_)
+    {
+      throw std::runtime_error("Not a compatible snapshot");
+    }
+
+    auto bidCount = reader.read<std::uint32_t>();
+    auto askCount = reader.read<std::uint32_t>();
+    auto orderCount = reader.read<std::uint64_t>();
+    if (orderCount > reader.remaining() / SnapshotFormat::orderSize_)
+    {
+      throw std::runtime_error("Snapshot is truncated");
+    }
+
+    reserve(static_cast<std::size_t>(orderCount));
+
+    std::vector<Level> bids;
+    std::vector<Level> asks;
+    try
+    {
+      bids = readLevels(reader, Side::Buy, bidCount);
+      asks = readLevels(reader, Side::Sell, askCount);
+    }
+    catch (...)
+    {
+      for (auto &[orderId, order] : existingOrders_)
+      {
+        allocator_.deallocate(order);
+      }
+      existingOrders_.clear();
+      expiries_.clear();
+      throw;
+    }
+
+    bidLevels_.restore(std::move(bids));
+    askLevels_.restore(std::move(asks));
+  }
+
   /**
    * @brief Matches aggressing order against resting orders
    */
-  Trades match(OrderId const &orderId, Side const &side, Price const &price,
-               Size &volume, auto const &onRemove)
+  void match(OrderId const &orderId, Side const &side, Price const &price,
+             Size &volume, auto &&onTrade, auto const &onRemove)
   {
     if (side == Side::Buy)
     {
-      return askLevels_.match(orderId, side, price, volume, onRemove);
+      askLevels_.template match<AllowAllOrNone>(
+          orderId, side, price, volume, onTrade, onRemove,
+          [&](Price levelPrice, Size levelSize)
+          { depth_.onLevel(Side::Sell, levelPrice, levelSize); });
     }
     else
     {
-      return bidLevels_.match(orderId, side, price, volume, onRemove);
+      bidLevels_.template match<AllowAllOrNone>(
+          orderId, side, price, volume, onTrade, onRemove,
+          [&](Price levelPrice, Size levelSize)
+          { depth_.onLevel(Side::Buy, levelPrice, levelSize); });
     }
   }
 
@@ -58,90 +256,672 @@ public:
     }
   }
 
+  /*
+   * @brief Matches/adds aggressing order of type Type
+   *
+   * @details Each order type gets its own instantiation, so none of the
+   *          checks on the order type are left for run time. Executions are
+   *          passed to onTrade as they happen, so no intermediate container
+   *          is allocated.
+   */
+  template <OrderType Type>
+  void addOrder(OrderId orderId, Side side, Price price, Size volume,
+                auto &&onTrade)
+  {
+    auto start = latency_.start();
+
+    if (!existingOrders_.contains(orderId))
+    {
+      journal_.record(Command{CommandType::Add, Type, side, SymbolId{},
+                              orderId, price, volume});
+      place<Type>(orderId, side, price, volume, onTrade);
+    }
+
+    latency_.stop(BookOperation::Add, Type, start);
+  }
+
+  /*
+   * @brief Matches/adds aggressing order of type Type
+   */
+  template <OrderType Type>
+  Trades addOrder(OrderId orderId, Side side, Price price, Size volume)
+  {
+    Trades trades;
+    addOrder<Type>(orderId, side, price, volume,
+                   [&](const Trade &trade) { trades.push_back(trade); });
+    return trades;
+  }
+
+  /*
+   * @brief Matches/adds aggressing order, according to its type
+   *
+   * @details Dispatches once on orderType to addOrder<Type>.
+   */
+  void addOrder(OrderType orderType, OrderId orderId, Side side, Price price,
+                Size volume, auto &&onTrade)
+  {
+    dispatch(orderType,
+             [&]<OrderType Type>()
+             { addOrder<Type>(orderId, side, price, volume, onTrade); });
+  }
+
   /*
    * @brief Matches/adds aggressing order, according to its type
    */
   Trades addOrder(OrderType orderType, OrderId orderId, Side side, Price price,
                   Size volume)
   {
-    if (existingOrders_.contains(orderId))
-      return {};
+    Trades trades;
+    addOrder(orderType, orderId, side, price, volume,
+             [&](const Trade &trade) { trades.push_back(trade); });
+    return trades;
+  }
+
+  /*
+   * @brief Cancels resting order
+   *
+   * @details Latency is recorded under the order's type, so cancels of
+   *          unknown ids are not recorded.
+   */
+  void cancelOrder(OrderId orderId)
+  {
+    auto start = latency_.start();
+
+    auto it = existingOrders_.find(orderId);
+    if (it == existingOrders_.end())
+      return;
 
-    if (orderType == OrderType::FillOrKill)
+    auto order = it->second;
+    auto orderType = order->getOrderType();
+    journal_.record(Command{CommandType::Cancel, orderType, order->getSide(),
+                            SymbolId{}, orderId, order->getPrice(),
+                            order->getRemainingSize()});
+    remove(it);
+
+    latency_.stop(BookOperation::Cancel, orderType, start);
+  }
+
+  /**
+   * @brief Adds a burst of orders, as addOrder would one after another
+   *
+   * @details Only orderType_, side_, orderId_, price_ and volume_ of each
+   *          command are read. Index slots are prefetched a few commands
+   *          ahead of their lookup.
+   */
+  void addOrders(std::span<const Command> commands, auto &&onTrade)
+  {
+    for (std::size_t i = 0; i < std::min(prefetchDistance_, commands.size());
+         ++i)
     {
-      if (!canFullyFill(side, price, volume))
+      prefetch(commands[i].orderId_);
+    }
+
+    for (std::size_t i = 0; i < commands.size(); ++i)
+    {
+      if (i + prefetchDistance_ < commands.size())
       {
-        return {};
+        prefetch(commands[i + prefetchDistance_].orderId_);
       }
+
+      const auto &command = commands[i];
+      addOrder(command.orderType_, command.orderId_, command.side_,
+               command.price_, command.volume_, onTrade);
     }
+  }
+
+  /**
+   * @brief Cancels a burst of orders, leaving the book as cancelOrder would
+   *
+   * @details Ids are looked up with prefetching, and the orders found are
+   *          journaled and reported to the event listener in the order
+   *          given. Unknown and repeated ids are skipped. Runs of
+   *          consecutive cancels on the same side and price, as a mass
+   *          cancel sends, are then taken off their level together, so the
+   *          level is found once and the depth listener told its volume
+   *          once; cancels on one level that arrive apart are taken off
+   *          separately. Batched cancels are not timed by the latency
+   *          recorder.
+   *
+   *          A journal that can fill up is asked for room for the orders
+   *          found before anything changes, so the batch is refused whole
+   *          when it would not fit. A repeated id counts each time it is
+   *          found, though only one cancel is journaled.
+   *
+   * @return the number of orders cancelled
+   */
+  std::size_t cancelOrders(std::span<const OrderId> orderIds)
+  {
+    constexpr bool canRefuse =
+        requires(std::size_t count) { journal_.reserve(count); };
+
+    cancelled_.clear();
+    cancelled_.reserve(orderIds.size());
+
+    for (std::size_t i = 0; i < std::min(prefetchDistance_, orderIds.size());
+         ++i)
+    {
+      prefetch(orderIds[i]);
+    }
+
+    for (std::size_t i = 0; i < orderIds.size(); ++i)
+    {
+      if (i + prefetchDistance_ < orderIds.size())
+      {
+        prefetch(orderIds[i + prefetchDistance_]);
+      }
+
+      auto it = existingOrders_.find(orderIds[i]);
+      if (it == existingOrders_.end())
+        continue;
+
+      auto order = it->second;
+      if constexpr (!canRefuse)
+      {
+        recordCancel(order);
+        existingOrders_.erase(it);
+        forgetExpiry(order);
+      }
+      cancelled_.push_back(order);
+    }
+
+    if constexpr (canRefuse)
+    {
+      reserveJournal(cancelled_.size());
+
+      // A repeated id found its order again, but only its first erase counts
+      auto kept = cancelled_.begin();
+      for (auto order : cancelled_)
+      {
+        if (existingOrders_.erase(order->getOrderId()) == 0)
+          continue;
+
+        recordCancel(order);
+        forgetExpiry(order);
+        *kept++ = order;
+      }
+      cancelled_.erase(kept, cancelled_.end());
+    }
+
+    takeCancelled();
+    return cancelled_.size();
+  }
+
+  /**
+   * @brief Sets when GoodForDay orders placed from now on expire
+   *
+   * @details Until a close is set they never expire. Orders already resting
+   *          keep the close they were placed under.
+   */
+  void setSessionClose(Timestamp close) { sessionClose_ = close; }
+
+  /**
+   * @brief Cancels every GoodForDay order whose session closed at or before
+   *        now
+   *
+   * @details Unless the journal has room for every order due, nothing is
+   *          expired and the journal's error is thrown. The orders due are
+   *          taken out of the expiry index, and scratch space for them
+   *          sized, before the book is changed. They are journaled and
+   *          reported to the event listener as cancels, then taken off
+   *          their levels by side and price, so a level whose every order
+   *          expires is dropped whole and the depth listener is told each
+   *          level's volume once. The work grows with the number of orders
+   *          expiring, not with the size of the book.
+   *
+   * @return the number of orders expired
+   */
+  std::size_t expire(Timestamp now)
+  {
+    reserveJournal(expiries_.due(now));
+    cancelled_.clear();
+    expiries_.take(now, cancelled_);
+
+    for (auto order : cancelled_)
+    {
+      recordCancel(order);
+      existingOrders_.erase(order->getOrderId());
+    }
+
+    std::sort(cancelled_.begin(), cancelled_.end(),
+              [](OrderPointer a, OrderPointer b)
+              {
+                return a->getSide() != b->getSide()
+                           ? a->getSide() < b->getSide()
+                           : a->getPrice() < b->getPrice();
+              });
+
+    takeCancelled();
+    return cancelled_.size();
+  }
+
+  /*
+   * @brief Modifies existing order, requeuing at the desired price level
+   *
+   * @details Reducing the remaining size of an order without changing its
+   *          type, side or price is done in place and keeps its queue
+   *          position. Any other change cancels the order and adds it anew.
+   */
+  void modifyOrder(OrderType newType, OrderId orderId, Side newSide,
+                   Price newPrice, Size newVolume, auto &&onTrade)
+  {
+    auto start = latency_.start();
+
+    journal_.record(Command{CommandType::Modify, newType, newSide, SymbolId{},
+                            orderId, newPrice, newVolume});
 
+    auto it = existingOrders_.find(orderId);
+    auto order = it != existingOrders_.end() ? it->second : nullptr;
+
+    if (order && newVolume > 0 && newVolume <= order->getRemainingSize() &&
+        newType == order->getOrderType() && newSide == order->getSide() &&
+        newPrice == order->getPrice())
+    {
+      amend(order, order->getRemainingSize() - newVolume);
+    }
+    else
+    {
+      if (order)
+      {
+        remove(it);
+      }
+      dispatch(newType,
+               [&]<OrderType Type>()
+               {
+                 place<Type>(orderId, newSide, newPrice, newVolume, onTrade);
+               });
+    }
+
+    latency_.stop(BookOperation::Modify, newType, start);
+  }
+
+  /*
+   * @brief Modifies existing order, requeuing at the desired price level
+   */
+  Trades modifyOrder(OrderType newType, OrderId orderId, Side newSide,
+                     Price newPrice, Size newVolume)
+  {
     Trades trades;
+    modifyOrder(newType, orderId, newSide, newPrice, newVolume,
+                [&](const Trade &trade) { trades.push_back(trade); });
+    return trades;
+  }
+
+private:
+  using Level = PriceLevel<OrderContainer>;
+
+  static constexpr std::size_t prefetchDistance_ = 8;
+
+  // Session close of GoodForDay orders placed before one is set
+  static constexpr Timestamp noExpiry_ = ~Timestamp{};
+
+  void prefetch(OrderId orderId) const
+  {
+    if constexpr (requires { existingOrders_.prefetch(orderId); })
+    {
+      existingOrders_.prefetch(orderId);
+    }
+  }
+
+  /*
+   * @brief Throws unless the journal can take count more records
+   *
+   * @details Journals that cannot fill up need no check.
+   */
+  void reserveJournal(std::size_t count) const
+  {
+    if constexpr (requires { journal_.reserve(count); })
+    {
+      journal_.reserve(count);
+    }
+  }
+
+  /*
+   * @brief Takes the orders in cancelled_, already out of the index, off
+   *        their levels and frees them
+   *
+   * @details Runs of orders on the same side and price are taken off their
+   *          level together, so the level is found once and the depth
+   *          listener told its volume once.
+   */
+  void takeCancelled()
+  {
+    auto sameLevel = [](OrderPointer a, OrderPointer b)
+    { return a->getSide() == b->getSide() && a->getPrice() == b->getPrice(); };
+
+    for (auto first = cancelled_.begin(); first != cancelled_.end();)
+    {
+      auto last = std::find_if_not(first + 1, cancelled_.end(),
+                                   [&](OrderPointer order)
+                                   { return sameLevel(order, *first); });
+      std::span<const OrderPointer> run{first, last};
+
+      auto side = (*first)->getSide();
+      auto price = (*first)->getPrice();
+      if (side == Side::Buy)
+      {
+        depth_.onLevel(side, price, bidLevels_.cancel(run));
+      }
+      else
+      {
+        depth_.onLevel(side, price, askLevels_.cancel(run));
+      }
+      first = last;
+    }
+
+    for (auto order : cancelled_)
+    {
+      allocator_.deallocate(order);
+    }
+  }
+
+  /*
+   * @brief Whether side's level container can hold levels from low to high
+   *        alongside those it has
+   *
+   * @details Only level containers with a bounded price range say no.
+   */
+  bool accepts(Side side, Price low, Price high) const
+  {
+    auto check = [&](const auto &levels)
+    {
+      if constexpr (requires { levels.accepts(low, high); })
+      {
+        return levels.accepts(low, high);
+      }
+      else
+      {
+        return true;
+      }
+    };
+    return side == Side::Buy ? check(bidLevels_) : check(askLevels_);
+  }
+
+  /*
+   * @brief Journals a cancel of order and reports its deletion
+   */
+  void recordCancel(OrderPointer order)
+  {
+    journal_.record(Command{CommandType::Cancel, order->getOrderType(),
+                            order->getSide(), SymbolId{}, order->getOrderId(),
+                            order->getPrice(), order->getRemainingSize()});
+    events_.onEvent(OrderEvent{OrderEventType::Delete, order->getSide(),
+                               order->getOrderId(), order->getPrice(),
+                               order->getRemainingSize()});
+  }
+
+  /*
+   * @brief Forgets a leaving order's expiry if it is GoodForDay
+   */
+  void forgetExpiry(OrderPointer order)
+  {
+    if (order->getOrderType() == OrderType::GoodForDay)
+    {
+      expiries_.erase(order);
+    }
+  }
+
+  /*
+   * @brief Reads count levels of side, allocating and indexing their orders
+   *
+   * @details Levels must come best first at distinct prices and hold at
+   *          least one order, and each order must have size left and a
+   *          type that can rest.
+   */
+  std::vector<Level> readLevels(SnapshotReader &reader, Side side,
+                                std::uint32_t count)
+  {
+    if (count > reader.remaining() / SnapshotFormat::levelSize_)
+    {
+      throw std::runtime_error("Snapshot is truncated");
+    }
+
+    std::vector<Level> levels;
+    levels.reserve(count);
+
+    for (std::uint32_t i = 0; i < count; ++i)
+    {
+      auto price = reader.read<Price>();
+      bool inOrder = levels.empty() || (side == Side::Buy
+                                            ? price < levels.back().price_
+                                            : price > levels.back().price_);
+      if (!inOrder)
+      {
+        throw std::runtime_error("Snapshot levels are out of order");
+      }
+
+      auto &level = levels.emplace_back(price);
+      auto orders = reader.read<std::uint32_t>();
+      if (orders == 0)
+      {
+        throw std::runtime_error("Snapshot holds an empty level");
+      }
+
+      for (std::uint32_t j = 0; j < orders; ++j)
+      {
+        auto orderId = reader.read<OrderId>();
+        auto size = reader.read<Size>();
+        auto type = static_cast<OrderType>(reader.read<std::uint8_t>());
+        if (size == 0)
+        {
+          throw std::runtime_error("Snapshot holds an order with no size");
+        }
+        if (type != OrderType::GoodTillCancel &&
+            type != OrderType::GoodForDay && type != OrderType::AllOrNone)
+        {
+          throw std::runtime_error("Snapshot holds an order that cannot rest");
+        }
+        if (!AllowAllOrNone && type == OrderType::AllOrNone)
+        {
+          throw std::runtime_error("Snapshot holds AllOrNone orders");
+        }
+
+        auto order =
+            allocator_.allocate(type, orderId, side, level.price_, size);
+        if (!existingOrders_.try_emplace(orderId, order).second)
+        {
+          allocator_.deallocate(order);
+          throw std::runtime_error("Snapshot repeats an order id");
+        }
+        if (type == OrderType::GoodForDay)
+        {
+          expiries_.insert(order, sessionClose_);
+        }
+        level.add(order);
+      }
+    }
+
+    if (!levels.empty() &&
+        !accepts(side, std::min(levels.front().price_, levels.back().price_),
+                 std::max(levels.front().price_, levels.back().price_)))
+    {
+      throw std::runtime_error("Snapshot prices do not fit the book");
+    }
+    return levels;
+  }
+
+  /*
+   * @brief Calls f.template operator()<Type>() for the runtime type
+   */
+  static void dispatch(OrderType type, auto &&f)
+  {
+    switch (type)
+    {
+    case OrderType::AllOrNone:
+      f.template operator()<OrderType::AllOrNone>();
+      break;
+    case OrderType::FillAndKill:
+      f.template operator()<OrderType::FillAndKill>();
+      break;
+    case OrderType::GoodForDay:
+      f.template operator()<OrderType::GoodForDay>();
+      break;
+    case OrderType::GoodTillCancel:
+      f.template operator()<OrderType::GoodTillCancel>();
+      break;
+    case OrderType::FillOrKill:
+      f.template operator()<OrderType::FillOrKill>();
+      break;
+    case OrderType::Market:
+      f.template operator()<OrderType::Market>();
+      break;
+    }
+  }
+
+  /*
+   * @brief Matches/adds an accepted order of type Type
+   */
+  template <OrderType Type>
+  void place(OrderId orderId, Side side, Price price, Size volume,
+             auto &&onTrade)
+  {
+    if constexpr (Type == OrderType::AllOrNone && !AllowAllOrNone)
+    {
+      return;
+    }
+
+    // Rejected before anything changes if it could not rest at its price
+    if constexpr (Type != OrderType::FillAndKill &&
+                  Type != OrderType::Market && Type != OrderType::FillOrKill)
+    {
+      if (!accepts(side, price, price))
+      {
+        return;
+      }
+    }
+
+    if constexpr (Type == OrderType::FillOrKill)
+    {
+      if (!canFullyFill(side, price, volume))
+      {
+        return;
+      }
+    }
 
     // Fill as much as possible
-    if (orderType != OrderType::AllOrNone || canFullyFill(side, price, volume))
+    if (Type != OrderType::AllOrNone || canFullyFill(side, price, volume))
     {
-      trades = match(orderId, side, price, volume, [&](OrderId filledId)
-                     { existingOrders_.erase(filledId); });
+      Side restingSide = side == Side::Buy ? Side::Sell : Side::Buy;
+
+      match(
+          orderId, side, price, volume,
+          [&](const Trade &trade)
+          {
+            auto resting = side == Side::Buy ? trade.getAsk() : trade.getBid();
+            events_.onEvent(OrderEvent{OrderEventType::Execute, restingSide,
+                                       resting.orderId_, resting.price_,
+                                       resting.size_});
+            onTrade(trade);
+          },
+          [&](OrderId filledId) { release(filledId); });
     }
 
     // Remaining not added to book
-    if (orderType == OrderType::FillAndKill || orderType == OrderType::Market ||
-        volume <= 0)
+    if constexpr (Type == OrderType::FillAndKill || Type == OrderType::Market)
     {
-      return trades;
+      return;
+    }
+
+    if (volume <= 0)
+    {
+      return;
     }
 
     // Add remainder to book to rest
-    auto order =
-        std::make_shared<Order>(orderType, orderId, side, price, volume);
+    auto order = allocator_.allocate(Type, orderId, side, price, volume);
     existingOrders_[orderId] = order;
+    if constexpr (Type == OrderType::GoodForDay)
+    {
+      expiries_.insert(order, sessionClose_);
+    }
+    events_.onEvent(
+        OrderEvent{OrderEventType::Add, side, orderId, price, volume});
     if (side == Side::Buy)
     {
-      bidLevels_.add(order);
+      depth_.onLevel(side, price, bidLevels_.add(order));
     }
     else
     {
-      askLevels_.add(order);
+      depth_.onLevel(side, price, askLevels_.add(order));
     }
-
-    return trades;
   }
 
   /*
-   * @brief Cancels resting order
+   * @brief Takes size off a resting order, keeping its queue position
    */
-  void cancelOrder(OrderId orderId)
+  void amend(OrderPointer order, Size size)
   {
-    if (!existingOrders_.contains(orderId))
+    if (size == 0)
       return;
 
-    auto order = existingOrders_[orderId];
+    events_.onEvent(OrderEvent{OrderEventType::Reduce, order->getSide(),
+                               order->getOrderId(), order->getPrice(),
+                               size});
 
     if (order->getSide() == Side::Buy)
     {
-      bidLevels_.cancel(order);
+      depth_.onLevel(Side::Buy, order->getPrice(),
+                     bidLevels_.reduce(order, size));
     }
     else
     {
-      askLevels_.cancel(order);
+      depth_.onLevel(Side::Sell, order->getPrice(),
+                     askLevels_.reduce(order, size));
     }
-
-    existingOrders_.erase(orderId);
   }
 
   /*
-   * @brief Modifies existing order, requeuing at the desired price level
+   * @brief Takes a resting order off the book
    */
-  Trades modifyOrder(OrderType newType, OrderId orderId, Side newSide,
-                     Price newPrice, Size newVolume)
+  void remove(typename OrderIndex::iterator it)
   {
-    cancelOrder(orderId);
+    auto order = it->second;
+    events_.onEvent(OrderEvent{OrderEventType::Delete, order->getSide(),
+                               order->getOrderId(), order->getPrice(),
+                               order->getRemainingSize()});
 
-    return addOrder(newType, orderId, newSide, newPrice, newVolume);
+    if (order->getSide() == Side::Buy)
+    {
+      depth_.onLevel(Side::Buy, order->getPrice(), bidLevels_.cancel(order));
+    }
+    else
+    {
+      depth_.onLevel(Side::Sell, order->getPrice(), askLevels_.cancel(order));
+    }
+
+    existingOrders_.erase(it);
+    forgetExpiry(order);
+    allocator_.deallocate(order);
+  }
+
+  /*
+   * @brief Forgets a filled order and returns its storage to the allocator
+   */
+  void release(OrderId orderId)
+  {
+    auto it = existingOrders_.find(orderId);
+    auto order = it->second;
+    events_.onEvent(OrderEvent{OrderEventType::Delete, order->getSide(),
+                               orderId, order->getPrice(),
+                               order->getRemainingSize()});
+    existingOrders_.erase(it);
+    forgetExpiry(order);
+    allocator_.deallocate(order);
   }
 
-private:
   LevelContainer<std::greater<Price>, OrderContainer> bidLevels_;
   LevelContainer<std::less<Price>, OrderContainer> askLevels_;
-  std::unordered_map<OrderId, OrderPointer> existingOrders_;
+  OrderIndex existingOrders_;
+  OrderAllocator allocator_;
+  DepthListener depth_;
+  OrderEventListener events_;
+  Journal journal_;
+  LatencyRecorder latency_;
+  ExpiryIndex expiries_;
+
+  // Expiry given to GoodForDay orders as they are placed
+  Timestamp sessionClose_;
+
+  // Scratch space for cancelOrders and expire, kept to avoid reallocating
+  // per batch
+  std::vector<OrderPointer> cancelled_;
 };
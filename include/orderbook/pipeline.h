@@ -0,0 +1,159 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+#include "orderbook/command.h"
+#include "orderbook/cpu_affinity.h"
+#include "orderbook/spsc_ring.h"
+#include "orderbook/trade.h"
+#include "orderbook/types.h"
+
+/**
+ * @brief Outcome of one Command, returned to the gateway that sent it
+ */
+struct CommandResult
+{
+  std::uint64_t sequence_;
+  OrderId orderId_;
+  Size filled_;
+  std::uint32_t trades_;
+  CommandType type_;
+};
+
+/**
+ * @brief Runs one book on a dedicated matching thread fed through rings
+ *
+ * @details Each gateway gets a lane: an inbound SpscRing of Command%s and an
+ *          outbound SpscRing of CommandResult%s, so every ring still has a
+ *          single producer and a single consumer. The matching thread visits
+ *          the lanes in turn and drains each in batches. Results carry the
+ *          lane's sequence number of the command, counted from zero.
+ *          Matching waits while a lane's outbound ring is full, so every
+ *          gateway has to keep polling its results.
+ *
+ * @tparam Book     the OrderBook type being driven
+ */
+template <typename Book> class OrderPipeline
+{
+public:
+  /**
+   * @param gateways        number of lanes, one per submitting thread
+   * @param ringCapacity    records each inbound and outbound ring can hold
+   * @param core            if not negative, the matching thread is pinned
+   *                        to it
+   */
+  explicit OrderPipeline(std::size_t gateways = 1,
+                         std::size_t ringCapacity = 65536, int core = -1)
+      : lanes_{}, book_{}, worker_{}
+  {
+    for (std::size_t i = 0; i < gateways; ++i)
+    {
+      lanes_.push_back(std::make_unique<Lane>(ringCapacity));
+    }
+
+    worker_ = std::jthread{[this](std::stop_token stop) { run(stop); }};
+
+    if (core >= 0)
+    {
+      pinToCore(worker_, core);
+    }
+  }
+
+  OrderPipeline(const OrderPipeline &) = delete;
+  OrderPipeline &operator=(const OrderPipeline &) = delete;
+
+  /**
+   * @brief Queues command on gateway's lane, waiting while it is full
+   */
+  void submit(std::size_t gateway, const Command &command)
+  {
+    while (!trySubmit(gateway, command))
+    {
+      std::this_thread::yield();
+    }
+  }
+
+  /**
+   * @brief Queues command on gateway's lane unless it is full
+   */
+  bool trySubmit(std::size_t gateway, const Command &command)
+  {
+    return lanes_[gateway]->inbound_.tryPush(command);
+  }
+
+  /**
+   * @brief Passes up to max results waiting on gateway's lane to onResult
+   *
+   * @return the number of results consumed
+   */
+  std::size_t pollResults(std::size_t gateway, std::size_t max,
+                          auto &&onResult)
+  {
+    return lanes_[gateway]->outbound_.popBatch(max, onResult);
+  }
+
+private:
+  static constexpr std::size_t batchSize_ = 256;
+
+  struct Lane
+  {
+    explicit Lane(std::size_t ringCapacity)
+        : inbound_{ringCapacity}, outbound_{ringCapacity}, sequence_{}
+    {
+    }
+
+    SpscRing<Command> inbound_;
+    SpscRing<CommandResult> outbound_;
+
+    // Matching thread only
+    std::uint64_t sequence_;
+  };
+
+  void run(std::stop_token stop)
+  {
+    while (!stop.stop_requested())
+    {
+      std::size_t count = 0;
+      for (auto &lane : lanes_)
+      {
+        count += lane->inbound_.popBatch(
+            batchSize_,
+            [&](const Command &command) { apply(*lane, command, stop); });
+      }
+
+      if (count == 0)
+      {
+        std::this_thread::yield();
+      }
+    }
+  }
+
+  void apply(Lane &lane, const Command &command, const std::stop_token &stop)
+  {
+    CommandResult result{lane.sequence_++, command.orderId_, 0, 0,
+                         command.type_};
+
+    command.applyTo(book_,
+                    [&](const Trade &trade)
+                    {
+                      ++result.trades_;
+                      result.filled_ += trade.getBid().size_;
+                    });
+
+    while (!lane.outbound_.tryPush(result) && !stop.stop_requested())
+    {
+      std::this_thread::yield();
+    }
+  }
+
+  std::vector<std::unique_ptr<Lane>> lanes_;
+  Book book_;
+
+  // Last, so the thread is joined before the book and lanes are destroyed
+  std::jthread worker_;
+};
@@ -1,14 +1,494 @@
 #pragma once
 
+#include "orderbook/all_or_none_queue.h"
+#include "orderbook/fill_kernel.h"
 #include "orderbook/order_policy.h"
+#include "orderbook/trade.h"
 #include "orderbook/types.h"
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <span>
+#include <vector>
 
+/**
+ * @brief Order containers that keep sizes in an array of slots, which
+ *        PriceLevel scans directly instead of through each Order
+ */
+template <typename OrderContainer>
+concept SlotOrderContainer =
+    requires(OrderContainer &orders, std::size_t slot, Size size) {
+      orders.firstSlot();
+      orders.order(slot);
+      orders.remaining(slot);
+      orders.fill(slot, size);
+    };
+
+/**
+ * @brief A SlotOrderContainer that also keeps each slot's arrival stamp and
+ *        its sizes in one array
+ */
+template <typename OrderContainer>
+concept ColumnOrderContainer =
+    SlotOrderContainer<OrderContainer> &&
+    requires(const OrderContainer &orders, std::size_t slot) {
+      orders.lastSlot();
+      orders.sequence(slot);
+      { orders.remainingSizes() } -> std::same_as<const Size *>;
+    };
+
+/**
+ * @brief The orders resting at one price
+ *
+ * @details AllOrNone orders are kept out of orders_, in an AllOrNoneQueue
+ *          of their own, so the queue is swept without checking order types
+ *          and AllOrNone orders too large to fill are passed over by size
+ *          without being looked at. Each order is stamped with its arrival
+ *          at the level, which keeps time priority between the two.
+ */
 template <typename OrderContainer> struct PriceLevel
 {
   Price price_;
   Size size_;
+  Size aonSize_;
   OrderContainer orders_;
+  AllOrNoneQueue allOrNone_;
+
+  // Stamp for the next order to arrive
+  std::uint32_t sequence_;
+
+  // Handle from the level container, stamped on every order added
+  std::uint32_t handle_;
+
+  PriceLevel(Price const &price)
+      : price_{price}, size_{}, aonSize_{}, orders_{}, allOrNone_{},
+        sequence_{}, handle_{}
+  {
+  }
+
+  bool empty() const { return orders_.empty() && allOrNone_.empty(); }
+
+  std::size_t count() const { return orders_.size() + allOrNone_.size(); }
+
+  /**
+   * @brief Queues order at the back of this level
+   */
+  void add(OrderPointer order)
+  {
+    size_ += order->getRemainingSize();
+    order->sequence_ = sequence_++;
+    order->level_ = handle_;
+
+    if (order->getOrderType() == OrderType::AllOrNone)
+    {
+      aonSize_ += order->getRemainingSize();
+      allOrNone_.push(order);
+    }
+    else
+    {
+      orders_.insert(order);
+    }
+  }
+
+  /**
+   * @brief Gives this level a new handle and stamps it on its orders
+   */
+  void setHandle(std::uint32_t handle)
+  {
+    handle_ = handle;
+    visit([&](OrderPointer order) { order->level_ = handle; });
+  }
+
+  /**
+   * @brief Removes order from this level
+   */
+  void erase(OrderPointer order)
+  {
+    size_ -= order->getRemainingSize();
+
+    if (order->getOrderType() == OrderType::AllOrNone)
+    {
+      aonSize_ -= order->getRemainingSize();
+      allOrNone_.erase(order);
+    }
+    else
+    {
+      orders_.erase(order);
+    }
+  }
+
+  /**
+   * @brief Removes orders, all of them resting at this level
+   *
+   * @details When they are every order here, the queues are dropped whole
+   *          instead of erasing orders one at a time. Otherwise containers
+   *          that can only erase by searching take the leaving orders out
+   *          in one pass, having marked them with a level handle no level
+   *          has; the others erase each order in O(1).
+   */
+  void erase(std::span<const OrderPointer> orders)
+  {
+    if (orders.size() == count())
+    {
+      size_ = 0;
+      aonSize_ = 0;
+      orders_ = OrderContainer{};
+      allOrNone_ = AllOrNoneQueue{};
+      return;
+    }
+
+    if constexpr (requires { orders_.eraseIf([](OrderPointer)
+                                             { return true; }); })
+    {
+      for (auto order : orders)
+      {
+        size_ -= order->getRemainingSize();
+        if (order->getOrderType() == OrderType::AllOrNone)
+        {
+          aonSize_ -= order->getRemainingSize();
+          allOrNone_.erase(order);
+        }
+        else
+        {
+          order->level_ = leaving_;
+        }
+      }
+
+      orders_.eraseIf([](OrderPointer order)
+                      { return order->level_ == leaving_; });
+    }
+    else
+    {
+      for (auto order : orders)
+      {
+        erase(order);
+      }
+    }
+  }
+
+  /**
+   * @brief Takes size off a queued order without moving it
+   */
+  void reduce(OrderPointer order, Size size)
+  {
+    size_ -= size;
+
+    if (order->getOrderType() == OrderType::AllOrNone)
+    {
+      aonSize_ -= size;
+      allOrNone_.reduce(order, size);
+      order->reduce(size);
+    }
+    else if constexpr (SlotOrderContainer<OrderContainer>)
+    {
+      orders_.reduce(order, size);
+    }
+    else
+    {
+      order->reduce(size);
+    }
+  }
+
+  /**
+   * @brief Passes every order to onOrder in time priority
+   */
+  void visit(auto &&onOrder) const
+  {
+    auto slot = allOrNone_.next(0);
+    for (const auto &order : orders_)
+    {
+      for (; slot != allOrNone_.lastSlot() &&
+             precedes(allOrNone_.sequence(slot), order->sequence_);
+           slot = allOrNone_.next(slot + 1))
+      {
+        onOrder(allOrNone_.order(slot));
+      }
+      onOrder(order);
+    }
+
+    for (; slot != allOrNone_.lastSlot(); slot = allOrNone_.next(slot + 1))
+    {
+      onOrder(allOrNone_.order(slot));
+    }
+  }
+
+  /**
+   * @brief Takes as much of volumeNeeded as this level could fill
+   *
+   * @details AllOrNone orders larger than the remaining need are skipped.
+   *          The aggregates give the answer unless the level holds
+   *          AllOrNone volume and neither its other volume covers
+   *          volumeNeeded nor its whole volume fits inside it. Then all of
+   *          the queue is taken and only the AllOrNone orders that fit what
+   *          is still needed are visited. The queue ahead of one is summed
+   *          only when it decides whether that order fits.
+   *
+   * @return true once volumeNeeded reaches zero
+   */
+  bool canFill(Size &volumeNeeded) const
+  {
+    Size queued = size_ - aonSize_;
+    if (queued >= volumeNeeded)
+    {
+      volumeNeeded = 0;
+      return true;
+    }
+
+    // Every AllOrNone order fits while the level's total does
+    if (aonSize_ == 0 || size_ <= volumeNeeded)
+    {
+      volumeNeeded -= size_;
+      return volumeNeeded == 0;
+    }
+
+    Size taken = 0;
+    Size ahead = 0;
+    auto next = firstQueued();
+
+    for (auto slot = allOrNone_.find(volumeNeeded - taken);
+         slot != allOrNone_.lastSlot();
+         slot = allOrNone_.find(volumeNeeded - taken, slot + 1))
+    {
+      Size size = allOrNone_.size(slot);
+      if (taken + queued + size > volumeNeeded)
+      {
+        ahead += queuedBefore(next, allOrNone_.sequence(slot));
+
+        if (taken + ahead + size > volumeNeeded)
+          continue;
+      }
+
+      taken += size;
+      if (taken + queued >= volumeNeeded)
+      {
+        volumeNeeded = 0;
+        return true;
+      }
+    }
+
+    volumeNeeded -= taken + queued;
+    return false;
+  }
+
+  /**
+   * @brief Matches aggressing order against this level in time priority
+   *
+   * @details Each execution is passed to onTrade. Filled orders are removed
+   *          from the level before onRemove is told about them. The queue
+   *          is swept up to the earliest AllOrNone order that fits, which
+   *          is then filled, until none fits; the rest of the queue is swept
+   *          without looking at them again.
+   *
+   * @tparam AllOrNone  false when the level can never hold AllOrNone
+   *                    orders, which drops the side queue entirely
+   */
+  template <bool AllOrNone = true>
+  void match(OrderId const &orderId, Side const &side, Size &volumeRemaining,
+             auto &&onTrade, const auto &onRemove)
+  {
+    if constexpr (AllOrNone)
+    {
+      // AllOrNone orders before from were too large and stay so, as the
+      // volume remaining only shrinks
+      std::size_t from = 0;
+      while (volumeRemaining > 0)
+      {
+        auto slot = allOrNone_.find(volumeRemaining, from);
+        if (slot == allOrNone_.lastSlot())
+          break;
+
+        from = slot;
+        sweep<true>(orderId, side, volumeRemaining, onTrade, onRemove,
+                    allOrNone_.sequence(slot));
+        if (allOrNone_.size(slot) > volumeRemaining)
+          continue;
+
+        auto resting = allOrNone_.order(slot);
+        Size tradeSize = allOrNone_.size(slot);
+        onTrade(tradeWith(orderId, side, resting->getOrderId(), tradeSize));
+
+        volumeRemaining -= tradeSize;
+        size_ -= tradeSize;
+        aonSize_ -= tradeSize;
+        resting->fill(tradeSize);
+
+        allOrNone_.erase(resting);
+        onRemove(resting->getOrderId());
+      }
+    }
+
+    sweep<false>(orderId, side, volumeRemaining, onTrade, onRemove, 0);
+  }
+
+private:
+  // Level handle marking orders erase(span) is about to take out
+  static constexpr std::uint32_t leaving_ = ~std::uint32_t{};
+
+  /**
+   * @brief Whether stamp a came before stamp b, allowing for wraparound
+   *        as long as a level's live orders span fewer than 2^31 arrivals
+   */
+  static bool precedes(std::uint32_t a, std::uint32_t b)
+  {
+    return static_cast<std::int32_t>(a - b) < 0;
+  }
+
+  /**
+   * @brief Where queuedBefore starts: a slot for containers that keep
+   *        sizes and stamps in columns, an iterator otherwise
+   */
+  auto firstQueued() const
+  {
+    if constexpr (ColumnOrderContainer<OrderContainer>)
+    {
+      return orders_.firstSlot();
+    }
+    else
+    {
+      return orders_.begin();
+    }
+  }
+
+  /**
+   * @brief Volume queued from next up to the arrival stamped sequence,
+   *        leaving next there
+   *
+   * @details Column containers find the end by binary search over the
+   *          stamps and sum the sizes with the fill kernel, tombstones
+   *          adding nothing; other containers walk their orders.
+   */
+  Size queuedBefore(auto &next, std::uint32_t sequence) const
+  {
+    if constexpr (ColumnOrderContainer<OrderContainer>)
+    {
+      auto first = next;
+      auto count = orders_.lastSlot() - first;
+      while (count > 0)
+      {
+        auto half = count / 2;
+        if (precedes(orders_.sequence(next + half), sequence))
+        {
+          next += half + 1;
+          count -= half + 1;
+        }
+        else
+        {
+          count = half;
+        }
+      }
+      return sumSizes(orders_.remainingSizes() + first, next - first);
+    }
+    else
+    {
+      Size queued = 0;
+      for (; next != orders_.end() && precedes((*next)->sequence_, sequence);
+           ++next)
+      {
+        queued += (*next)->getRemainingSize();
+      }
+      return queued;
+    }
+  }
+
+  Trade tradeWith(OrderId const &orderId, Side const &side, OrderId restingId,
+                  Size tradeSize) const
+  {
+    TradeData incomingData{orderId, price_, tradeSize};
+    TradeData restingData{restingId, price_, tradeSize};
+
+    if (side == Side::Buy)
+    {
+      return Trade{incomingData, restingData};
+    }
+    else
+    {
+      return Trade{restingData, incomingData};
+    }
+  }
+
+  /**
+   * @brief Matches against the queue in time priority
+   *
+   * @tparam Bounded    true to stop at the first order not stamped before
+   *                    before
+   */
+  template <bool Bounded>
+  void sweep(OrderId const &orderId, Side const &side, Size &volumeRemaining,
+             auto &&onTrade, const auto &onRemove, std::uint32_t before)
+  {
+    if constexpr (SlotOrderContainer<OrderContainer>)
+    {
+      sweepSlots<Bounded>(orderId, side, volumeRemaining, onTrade, onRemove,
+                          before);
+      return;
+    }
+
+    for (auto ord = orders_.begin();
+         ord != orders_.end() && volumeRemaining > 0;)
+    {
+      auto resting = *ord;
+
+      if constexpr (Bounded)
+      {
+        if (!precedes(resting->sequence_, before))
+          break;
+      }
+
+      Size tradeSize = std::min(volumeRemaining, resting->getRemainingSize());
+      onTrade(tradeWith(orderId, side, resting->getOrderId(), tradeSize));
+
+      volumeRemaining -= tradeSize;
+      size_ -= tradeSize;
+      resting->fill(tradeSize);
+
+      if (resting->isFilled())
+      {
+        ord = orders_.erase(ord);
+        onRemove(resting->getOrderId());
+      }
+      else
+      {
+        ++ord;
+      }
+    }
+  }
+
+  /**
+   * @brief sweep for slot containers, reading each resting order's id and
+   *        size from the slot arrays
+   */
+  template <bool Bounded>
+  void sweepSlots(OrderId const &orderId, Side const &side,
+                  Size &volumeRemaining, auto &&onTrade, const auto &onRemove,
+                  std::uint32_t before)
+  {
+    for (auto slot = orders_.firstSlot();
+         slot < orders_.lastSlot() && volumeRemaining > 0; ++slot)
+    {
+      Size remaining = orders_.remaining(slot);
+      if (remaining == 0)
+        continue;
+
+      if constexpr (Bounded)
+      {
+        if (!precedes(orders_.order(slot)->sequence_, before))
+          break;
+      }
+
+      Size tradeSize = std::min(volumeRemaining, remaining);
+      OrderId restingId = orders_.id(slot);
+      onTrade(tradeWith(orderId, side, restingId, tradeSize));
+
+      volumeRemaining -= tradeSize;
+      size_ -= tradeSize;
 
-  PriceLevel(Price const &price) : price_{price}, size_{}, orders_{} {}
+      if (orders_.fill(slot, tradeSize))
+      {
+        orders_.eraseSlot(slot);
+        onRemove(restingId);
+      }
+    }
+  }
 };
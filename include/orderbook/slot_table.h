@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Stable 32-bit handles to positions in a container
+ *
+ * @details Each handle names a slot holding the current position of one
+ *          element, so an element that moves or can only be erased through
+ *          an iterator is still reached in O(1) from a handle stored
+ *          alongside it. Released slots are reused, keeping the table as
+ *          large as the most elements held at once.
+ *
+ * @tparam Position   what reaches an element in O(1), such as an iterator
+ *                    or index, or the element itself
+ */
+template <typename Position> class SlotTable
+{
+public:
+  SlotTable() : positions_{}, free_{} {}
+
+  /**
+   * @brief Takes a free slot for position
+   *
+   * @return the slot's handle
+   */
+  std::uint32_t acquire(Position position)
+  {
+    if (free_.empty())
+    {
+      positions_.push_back(std::move(position));
+
+      // Room for every handle to be released without allocating
+      if (free_.capacity() < positions_.size())
+      {
+        free_.reserve(positions_.capacity());
+      }
+      return static_cast<std::uint32_t>(positions_.size() - 1);
+    }
+
+    auto handle = free_.back();
+    free_.pop_back();
+    positions_[handle] = std::move(position);
+    return handle;
+  }
+
+  /**
+   * @brief Gives handle's slot back for reuse, without allocating
+   */
+  void release(std::uint32_t handle) { free_.push_back(handle); }
+
+  Position &operator[](std::uint32_t handle) { return positions_[handle]; }
+
+  const Position &operator[](std::uint32_t handle) const
+  {
+    return positions_[handle];
+  }
+
+  /**
+   * @brief Number of handles currently held
+   */
+  std::size_t size() const { return positions_.size() - free_.size(); }
+
+private:
+  std::vector<Position> positions_;
+  std::vector<std::uint32_t> free_;
+};
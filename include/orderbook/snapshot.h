@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+
+#include "orderbook/types.h"
+
+/**
+ * @brief Layout of an OrderBook snapshot
+ *
+ * @details A header of magic, version, bid level count, ask level count and
+ *          order count is followed by the bid levels and then the ask
+ *          levels, each side best first. A level is its price and order
+ *          count followed by its orders in time priority, each stored as
+ *          id, remaining size and type. Fields are packed in native byte
+ *          order with no padding.
+ */
+struct SnapshotFormat
+{
+  static constexpr std::uint64_t magic_ = 0x31504E534B424F4Full;
+  static constexpr std::uint32_t version_ = 1;
+
+  static constexpr std::size_t headerSize_ =
+      sizeof(std::uint64_t) + 3 * sizeof(std::uint32_t) +
+      sizeof(std::uint64_t);
+  static constexpr std::size_t levelSize_ =
+      sizeof(Price) + sizeof(std::uint32_t);
+  static constexpr std::size_t orderSize_ =
+      sizeof(OrderId) + sizeof(Size) + sizeof(std::uint8_t);
+};
+
+/**
+ * @brief Writes packed fields into a buffer sized up front
+ */
+class SnapshotWriter
+{
+public:
+  explicit SnapshotWriter(std::span<std::byte> buffer)
+      : buffer_{buffer}, offset_{}
+  {
+  }
+
+  template <typename T> void write(const T &value)
+  {
+    static_assert(std::is_trivially_copyable_v<T>);
+    std::memcpy(buffer_.data() + offset_, &value, sizeof(T));
+    offset_ += sizeof(T);
+  }
+
+private:
+  std::span<std::byte> buffer_;
+  std::size_t offset_;
+};
+
+/**
+ * @brief Reads packed fields back, throwing if the buffer runs out
+ */
+class SnapshotReader
+{
+public:
+  explicit SnapshotReader(std::span<const std::byte> buffer)
+      : buffer_{buffer}, offset_{}
+  {
+  }
+
+  std::size_t remaining() const { return buffer_.size() - offset_; }
+
+  template <typename T> T read()
+  {
+    static_assert(std::is_trivially_copyable_v<T>);
+    if (remaining() < sizeof(T))
+    {
+      throw std::runtime_error("Snapshot is truncated");
+    }
+
+    T value;
+    std::memcpy(&value, buffer_.data() + offset_, sizeof(T));
+    offset_ += sizeof(T);
+    return value;
+  }
+
+private:
+  std::span<const std::byte> buffer_;
+  std::size_t offset_;
+};
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief Bounded lock-free queue for one producer and one consumer thread
+ *
+ * @details Each side owns one cache line holding its own index and a cached
+ *          copy of the other side's index, so the shared index is only
+ *          re-read when the cached copy says the ring looks full or empty.
+ *
+ * @tparam T    the record type, copied in and out of the ring
+ */
+template <typename T> class SpscRing
+{
+public:
+  static constexpr std::size_t cacheLineSize = 64;
+
+  /**
+   * @param capacity    rounded up to the next power of two
+   */
+  explicit SpscRing(std::size_t capacity)
+      : consumer_{}, producer_{},
+        slots_(std::bit_ceil(std::max<std::size_t>(capacity, 2))),
+        mask_{slots_.size() - 1}
+  {
+  }
+
+  SpscRing(const SpscRing &) = delete;
+  SpscRing &operator=(const SpscRing &) = delete;
+
+  std::size_t capacity() const { return slots_.size(); }
+
+  /**
+   * @brief Producer only, returns false when the ring is full
+   */
+  bool tryPush(const T &value)
+  {
+    auto tail = producer_.index_.load(std::memory_order_relaxed);
+
+    if (tail - producer_.cached_ == slots_.size())
+    {
+      producer_.cached_ = consumer_.index_.load(std::memory_order_acquire);
+      if (tail - producer_.cached_ == slots_.size())
+        return false;
+    }
+
+    slots_[tail & mask_] = value;
+    producer_.index_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @brief Consumer only, returns false when the ring is empty
+   */
+  bool tryPop(T &value)
+  {
+    return popBatch(1, [&](const T &slot) { value = slot; }) == 1;
+  }
+
+  /**
+   * @brief Consumer only, passes up to max queued records to onValue
+   *
+   * @details The slots are handed back to the producer once, after the
+   *          whole batch has been consumed.
+   *
+   * @return the number of records consumed
+   */
+  std::size_t popBatch(std::size_t max, auto &&onValue)
+  {
+    auto head = consumer_.index_.load(std::memory_order_relaxed);
+
+    if (consumer_.cached_ == head)
+    {
+      consumer_.cached_ = producer_.index_.load(std::memory_order_acquire);
+      if (consumer_.cached_ == head)
+        return 0;
+    }
+
+    auto count = std::min(consumer_.cached_ - head, max);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+      onValue(slots_[(head + i) & mask_]);
+    }
+
+    consumer_.index_.store(head + count, std::memory_order_release);
+    return count;
+  }
+
+  /**
+   * @brief Approximate number of queued records, safe from either side
+   */
+  std::size_t size() const
+  {
+    return producer_.index_.load(std::memory_order_acquire) -
+           consumer_.index_.load(std::memory_order_acquire);
+  }
+
+  bool empty() const { return size() == 0; }
+
+private:
+  struct alignas(cacheLineSize) Cursor
+  {
+    std::atomic<std::size_t> index_{};
+    // Last value seen of the other side's index
+    std::size_t cached_{};
+  };
+
+  Cursor consumer_;
+  Cursor producer_;
+  std::vector<T> slots_;
+  std::size_t mask_;
+};
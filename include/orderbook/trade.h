@@ -1,5 +1,8 @@
 #pragma once
 
+#include <algorithm>
+#include <cstddef>
+#include <span>
 #include <vector>
 
 #include "orderbook/order.h"
@@ -15,6 +18,7 @@ struct TradeData
 class Trade
 {
 public:
+  Trade() : bid_{}, ask_{} {}
   Trade(const TradeData &bid, const TradeData &ask) : bid_{bid}, ask_{ask} {}
 
   const TradeData getBid() const { return bid_; }
@@ -26,3 +30,40 @@ private:
 };
 
 using Trades = std::vector<Trade>;
+
+/**
+ * @brief Trade sink writing into caller-owned storage
+ *
+ * @details Trades beyond the end of the storage are counted but dropped, so
+ *          the caller can detect overflow with overflowed().
+ */
+class SpanTradeSink
+{
+public:
+  explicit SpanTradeSink(std::span<Trade> storage)
+      : storage_{storage}, count_{}
+  {
+  }
+
+  void operator()(const Trade &trade)
+  {
+    if (count_ < storage_.size())
+    {
+      storage_[count_] = trade;
+    }
+    ++count_;
+  }
+
+  std::span<const Trade> trades() const
+  {
+    return storage_.first(std::min(count_, storage_.size()));
+  }
+
+  std::size_t count() const { return count_; }
+  bool overflowed() const { return count_ > storage_.size(); }
+  void clear() { count_ = 0; }
+
+private:
+  std::span<Trade> storage_;
+  std::size_t count_;
+};
@@ -5,6 +5,8 @@
 using Price = std::int64_t;
 using Size = std::uint64_t;
 using OrderId = std::uint64_t;
+using SymbolId = std::uint32_t;
+using Timestamp = std::uint64_t;
 
 enum class Side
 {
@@ -0,0 +1,147 @@
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <random>
+#include <vector>
+
+#include "orderbook/all_or_none_queue.h"
+
+namespace
+{
+std::deque<Order> makeOrders(const std::vector<Size> &sizes)
+{
+  std::deque<Order> orders;
+  for (std::size_t i = 0; i < sizes.size(); ++i)
+  {
+    orders.emplace_back(OrderType::AllOrNone, OrderId{i}, Side::Sell,
+                        Price{100}, sizes[i]);
+  }
+  return orders;
+}
+} // namespace
+
+TEST(AllOrNoneQueueTest, FindsFirstFitAtOrAfterSlot)
+{
+  auto orders = makeOrders({9, 4, 7, 2, 8});
+  AllOrNoneQueue queue;
+  for (auto &order : orders)
+  {
+    queue.push(&order);
+  }
+
+  EXPECT_EQ(queue.size(), 5);
+  EXPECT_EQ(queue.find(5), 1);
+  EXPECT_EQ(queue.find(5, 2), 3);
+  EXPECT_EQ(queue.find(1), queue.lastSlot());
+  EXPECT_EQ(queue.find(100, 4), 4);
+  EXPECT_EQ(queue.order(queue.find(3)), &orders[3]);
+}
+
+TEST(AllOrNoneQueueTest, EraseAndReduceUpdateSearch)
+{
+  auto orders = makeOrders({9, 4, 7, 2});
+  AllOrNoneQueue queue;
+  for (auto &order : orders)
+  {
+    queue.push(&order);
+  }
+
+  queue.erase(&orders[1]);
+  EXPECT_EQ(queue.find(5), 3);
+  EXPECT_EQ(queue.next(1), 2);
+
+  queue.reduce(&orders[0], 6);
+  EXPECT_EQ(queue.size(0), 3);
+  EXPECT_EQ(queue.find(5), 0);
+  EXPECT_EQ(queue.size(), 3);
+}
+
+TEST(AllOrNoneQueueTest, CompactsKeepingArrivalOrder)
+{
+  auto orders = makeOrders(std::vector<Size>(40, Size{5}));
+  AllOrNoneQueue queue;
+  for (std::size_t i = 0; i < 30; ++i)
+  {
+    queue.push(&orders[i]);
+  }
+  for (std::size_t i = 0; i < 30; i += 3)
+  {
+    queue.erase(&orders[i]);
+    queue.erase(&orders[i + 1]);
+  }
+
+  // Twenty tombstones to ten live entries, so the first push compacts
+  for (std::size_t i = 30; i < 40; ++i)
+  {
+    queue.push(&orders[i]);
+  }
+  EXPECT_EQ(queue.lastSlot(), 20);
+
+  // The live orders, in the order they came
+  std::vector<OrderId> live;
+  for (auto slot = queue.next(0); slot != queue.lastSlot();
+       slot = queue.next(slot + 1))
+  {
+    live.push_back(queue.order(slot)->getOrderId());
+    EXPECT_EQ(queue.find(5, slot), slot);
+  }
+
+  std::vector<OrderId> expected;
+  for (OrderId id = 2; id < 30; id += 3)
+  {
+    expected.push_back(id);
+  }
+  for (OrderId id = 30; id < 40; ++id)
+  {
+    expected.push_back(id);
+  }
+  EXPECT_EQ(live, expected);
+  EXPECT_EQ(queue.size(), expected.size());
+}
+
+TEST(AllOrNoneQueueTest, MatchesLinearSearch)
+{
+  std::mt19937_64 rng{42};
+  std::uniform_int_distribution<Size> size{1, 50};
+
+  std::deque<Order> orders;
+  std::vector<OrderPointer> live;
+  AllOrNoneQueue queue;
+
+  for (int round = 0; round < 5000; ++round)
+  {
+    if (live.empty() || rng() % 3 != 0)
+    {
+      orders.emplace_back(OrderType::AllOrNone, OrderId(orders.size()),
+                          Side::Sell, Price{100}, size(rng));
+      queue.push(&orders.back());
+      live.push_back(&orders.back());
+    }
+    else
+    {
+      auto i = rng() % live.size();
+      queue.erase(live[i]);
+      live.erase(live.begin() + static_cast<std::ptrdiff_t>(i));
+    }
+
+    // live is in arrival order, as the queue's slots are
+    Size limit = size(rng);
+    OrderPointer expected = nullptr;
+    for (auto order : live)
+    {
+      if (order->getRemainingSize() <= limit)
+      {
+        expected = order;
+        break;
+      }
+    }
+
+    auto slot = queue.find(limit);
+    ASSERT_EQ(slot == queue.lastSlot() ? nullptr : queue.order(slot),
+              expected)
+        << "round " << round;
+    ASSERT_EQ(queue.size(), live.size());
+  }
+}
@@ -0,0 +1,178 @@
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "orderbook/command.h"
+#include "orderbook/orderbook.h"
+
+// Two prices to a chunk, so chunks split and merge all the time
+template <typename Compare, typename OrderContainer>
+using PairChunkedLevelPolicy =
+    BasicChunkedLevelPolicy<Compare, OrderContainer, 2>;
+
+using BatchBookPolicies =
+    ::testing::Types<OrderBook<MapLevelPolicy, DequeOrderPolicy>,
+                     OrderBook<MapLevelPolicy, ListOrderPolicy>,
+                     OrderBook<VectorLevelPolicy, VectorOrderPolicy>,
+                     OrderBook<VectorLevelPolicy, IntrusiveOrderPolicy>,
+                     OrderBook<VectorLevelPolicy, ColumnarOrderPolicy>,
+                     OrderBook<ListLevelPolicy, ListOrderPolicy>,
+                     OrderBook<ListLevelPolicy, DequeOrderPolicy>,
+                     OrderBook<ListLevelPolicy, TombstoneDequeOrderPolicy>,
+                     OrderBook<ArrayLevelPolicy, VectorOrderPolicy>,
+                     OrderBook<ChunkedLevelPolicy, VectorOrderPolicy>,
+                     OrderBook<PairChunkedLevelPolicy, IntrusiveOrderPolicy>,
+                     OrderBook<ArrayLevelPolicy, IntrusiveOrderPolicy,
+                               PoolOrderAllocator, FlatOrderIndex>>;
+
+template <typename OrderBookPolicy> class BatchTest : public testing::Test
+{
+public:
+  using Levels = std::vector<std::pair<Price, Size>>;
+
+  static Levels depth(const OrderBookPolicy &book, Side side)
+  {
+    Levels levels;
+    book.snapshotDepth(side, 1000, [&](Price price, Size size)
+                       { levels.emplace_back(price, size); });
+    return levels;
+  }
+
+  OrderBookPolicy sequential_;
+  OrderBookPolicy batched_;
+};
+
+TYPED_TEST_SUITE(BatchTest, BatchBookPolicies);
+
+TYPED_TEST(BatchTest, MatchesSequentialCalls)
+{
+  std::mt19937_64 rng{7};
+  std::uniform_int_distribution<Price> offset{0, 12};
+  std::uniform_int_distribution<Size> size{1, 20};
+  std::uniform_int_distribution<int> type{0, 9};
+
+  std::vector<Trade> sequentialTrades;
+  std::vector<Trade> batchedTrades;
+  std::size_t batchedCancels = 0;
+  OrderId nextId = 0;
+
+  for (int round = 0; round < 50; ++round)
+  {
+    std::vector<Command> adds;
+    for (int i = 0; i < 40; ++i)
+    {
+      Side side = i % 2 ? Side::Buy : Side::Sell;
+      Price price = side == Side::Buy ? 100 - offset(rng) + 2
+                                      : 100 + offset(rng) - 2;
+      auto draw = type(rng);
+      auto orderType = draw == 0   ? OrderType::AllOrNone
+                       : draw == 1 ? OrderType::FillOrKill
+                       : draw == 2 ? OrderType::FillAndKill
+                                   : OrderType::GoodTillCancel;
+      adds.push_back(Command{CommandType::Add, orderType, side, SymbolId{},
+                             nextId++, price, size(rng)});
+    }
+
+    // Includes ids already filled or cancelled, and a repeat
+    std::vector<OrderId> cancels;
+    std::uniform_int_distribution<OrderId> id{0, nextId - 1};
+    for (int i = 0; i < 25; ++i)
+    {
+      cancels.push_back(id(rng));
+    }
+    cancels.push_back(cancels.front());
+
+    for (const auto &add : adds)
+    {
+      this->sequential_.addOrder(
+          add.orderType_, add.orderId_, add.side_, add.price_, add.volume_,
+          [&](const Trade &trade) { sequentialTrades.push_back(trade); });
+    }
+    for (auto cancel : cancels)
+    {
+      this->sequential_.cancelOrder(cancel);
+    }
+
+    this->batched_.addOrders(adds, [&](const Trade &trade)
+                             { batchedTrades.push_back(trade); });
+    batchedCancels += this->batched_.cancelOrders(cancels);
+
+    ASSERT_EQ(this->depth(this->batched_, Side::Buy),
+              this->depth(this->sequential_, Side::Buy));
+    ASSERT_EQ(this->depth(this->batched_, Side::Sell),
+              this->depth(this->sequential_, Side::Sell));
+  }
+
+  ASSERT_EQ(batchedTrades.size(), sequentialTrades.size());
+  for (std::size_t i = 0; i < batchedTrades.size(); ++i)
+  {
+    EXPECT_EQ(batchedTrades[i].getBid().orderId_,
+              sequentialTrades[i].getBid().orderId_);
+    EXPECT_EQ(batchedTrades[i].getAsk().orderId_,
+              sequentialTrades[i].getAsk().orderId_);
+    EXPECT_EQ(batchedTrades[i].getBid().size_,
+              sequentialTrades[i].getBid().size_);
+  }
+  EXPECT_GT(batchedCancels, 0);
+}
+
+TYPED_TEST(BatchTest, CancelsCountOnlyLiveOrders)
+{
+  this->batched_.addOrder(OrderType::GoodTillCancel, OrderId{1}, Side::Buy,
+                          Price{100}, Size{10});
+  this->batched_.addOrder(OrderType::GoodTillCancel, OrderId{2}, Side::Buy,
+                          Price{100}, Size{10});
+  this->batched_.addOrder(OrderType::GoodTillCancel, OrderId{3}, Side::Sell,
+                          Price{105}, Size{10});
+
+  std::vector<OrderId> ids{2, 9, 3, 2};
+  EXPECT_EQ(this->batched_.cancelOrders(ids), 2);
+  EXPECT_EQ(this->depth(this->batched_, Side::Buy),
+            (typename TestFixture::Levels{{100, 10}}));
+  EXPECT_TRUE(this->depth(this->batched_, Side::Sell).empty());
+
+  std::vector<OrderId> last{1};
+  EXPECT_EQ(this->batched_.cancelOrders(last), 1);
+  EXPECT_TRUE(this->batched_.empty());
+}
+
+TYPED_TEST(BatchTest, CancelsInterleavedLevels)
+{
+  for (OrderId id = 1; id <= 6; ++id)
+  {
+    this->batched_.addOrder(OrderType::GoodTillCancel, id, Side::Buy,
+                            Price{100} + static_cast<Price>(id % 3), Size{10});
+  }
+
+  std::vector<OrderId> ids{1, 2, 3, 4, 5};
+  EXPECT_EQ(this->batched_.cancelOrders(ids), 5);
+  EXPECT_EQ(this->depth(this->batched_, Side::Buy),
+            (typename TestFixture::Levels{{100, 10}}));
+}
+
+TYPED_TEST(BatchTest, CancelsPartOfALevelKeepingQueueOrder)
+{
+  for (OrderId id = 1; id <= 6; ++id)
+  {
+    this->batched_.addOrder(OrderType::GoodTillCancel, id, Side::Buy,
+                            Price{100}, static_cast<Size>(id));
+  }
+
+  std::vector<OrderId> ids{2, 4, 5};
+  EXPECT_EQ(this->batched_.cancelOrders(ids), 3);
+  EXPECT_EQ(this->depth(this->batched_, Side::Buy),
+            (typename TestFixture::Levels{{100, 10}}));
+
+  // Orders 1 and 3 are ahead of 6, so a sale of 4 fills exactly them
+  this->batched_.addOrder(OrderType::GoodTillCancel, OrderId{7}, Side::Sell,
+                          Price{100}, Size{4});
+  EXPECT_EQ(this->depth(this->batched_, Side::Buy),
+            (typename TestFixture::Levels{{100, 6}}));
+
+  std::vector<OrderId> last{6};
+  EXPECT_EQ(this->batched_.cancelOrders(last), 1);
+  EXPECT_TRUE(this->batched_.empty());
+}
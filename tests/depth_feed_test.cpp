@@ -0,0 +1,142 @@
+#include <gtest/gtest.h>
+
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "orderbook/depth_feed.h"
+#include "orderbook/orderbook.h"
+
+template <template <typename, typename> class LevelContainer>
+using DepthBook =
+    OrderBook<LevelContainer, IntrusiveOrderPolicy, PoolOrderAllocator,
+              std::unordered_map<OrderId, OrderPointer>, DepthFeed>;
+
+using DepthBookPolicies =
+    ::testing::Types<DepthBook<MapLevelPolicy>, DepthBook<VectorLevelPolicy>,
+                     DepthBook<ListLevelPolicy>, DepthBook<ArrayLevelPolicy>>;
+
+template <typename OrderBookPolicy> class DepthFeedTest : public testing::Test
+{
+public:
+  std::vector<std::pair<Price, Size>> updates(Side side) const
+  {
+    std::vector<std::pair<Price, Size>> result;
+    for (const auto &update : orderbook_.depthListener().updates())
+    {
+      if (update.side_ == side)
+      {
+        result.emplace_back(update.price_, update.size_);
+      }
+    }
+    return result;
+  }
+
+  OrderBookPolicy orderbook_;
+};
+
+TYPED_TEST_SUITE(DepthFeedTest, DepthBookPolicies);
+
+using Levels = std::vector<std::pair<Price, Size>>;
+
+TYPED_TEST(DepthFeedTest, ReportsEveryLevelChange)
+{
+  this->orderbook_.addOrder(OrderType::GoodTillCancel, OrderId{1}, Side::Sell,
+                            Price{100}, Size{10});
+  this->orderbook_.addOrder(OrderType::GoodTillCancel, OrderId{2}, Side::Sell,
+                            Price{100}, Size{5});
+  this->orderbook_.addOrder(OrderType::GoodTillCancel, OrderId{3}, Side::Sell,
+                            Price{101}, Size{7});
+  this->orderbook_.cancelOrder(OrderId{2});
+  this->orderbook_.addOrder(OrderType::GoodTillCancel, OrderId{4}, Side::Buy,
+                            Price{101}, Size{12});
+
+  EXPECT_EQ(this->updates(Side::Sell),
+            (Levels{{100, 10}, {100, 15}, {101, 7}, {100, 10}, {100, 0},
+                    {101, 5}}));
+  EXPECT_TRUE(this->updates(Side::Buy).empty());
+
+  this->orderbook_.depthListener().clear();
+  this->orderbook_.addOrder(OrderType::GoodTillCancel, OrderId{5}, Side::Buy,
+                            Price{99}, Size{3});
+
+  EXPECT_EQ(this->updates(Side::Buy), (Levels{{99, 3}}));
+  EXPECT_TRUE(this->updates(Side::Sell).empty());
+}
+
+TYPED_TEST(DepthFeedTest, SkipsLevelsMatchLeavesUnchanged)
+{
+  this->orderbook_.addOrder(OrderType::AllOrNone, OrderId{1}, Side::Sell,
+                            Price{100}, Size{50});
+  this->orderbook_.addOrder(OrderType::GoodTillCancel, OrderId{2}, Side::Sell,
+                            Price{101}, Size{5});
+  this->orderbook_.depthListener().clear();
+
+  // Passes over the AllOrNone order, too big to fill, to trade at 101
+  auto trades = this->orderbook_.addOrder(
+      OrderType::FillAndKill, OrderId{3}, Side::Buy, Price{101}, Size{5});
+  ASSERT_EQ(trades.size(), 1);
+
+  EXPECT_EQ(this->updates(Side::Sell), (Levels{{101, 0}}));
+  EXPECT_TRUE(this->updates(Side::Buy).empty());
+}
+
+TYPED_TEST(DepthFeedTest, ConflatesChangesWithinBatch)
+{
+  TypeParam orderbook{DepthFeed{true}};
+  auto &feed = orderbook.depthListener();
+
+  orderbook.addOrder(OrderType::GoodTillCancel, OrderId{1}, Side::Sell,
+                     Price{100}, Size{10});
+  orderbook.addOrder(OrderType::GoodTillCancel, OrderId{2}, Side::Buy,
+                     Price{100}, Size{10});
+  orderbook.addOrder(OrderType::GoodTillCancel, OrderId{3}, Side::Sell,
+                     Price{101}, Size{4});
+  orderbook.addOrder(OrderType::GoodTillCancel, OrderId{4}, Side::Buy,
+                     Price{99}, Size{6});
+  orderbook.modifyOrder(OrderType::GoodTillCancel, OrderId{3}, Side::Sell,
+                        Price{101}, Size{8});
+
+  ASSERT_EQ(feed.updates().size(), 3);
+  EXPECT_EQ(feed.updates()[0].side_, Side::Sell);
+  EXPECT_EQ(feed.updates()[0].price_, 100);
+  EXPECT_EQ(feed.updates()[0].size_, 0);
+  EXPECT_EQ(feed.updates()[1].price_, 101);
+  EXPECT_EQ(feed.updates()[1].size_, 8);
+  EXPECT_EQ(feed.updates()[2].side_, Side::Buy);
+  EXPECT_EQ(feed.updates()[2].price_, 99);
+  EXPECT_EQ(feed.updates()[2].size_, 6);
+
+  feed.clear();
+  orderbook.cancelOrder(OrderId{4});
+
+  ASSERT_EQ(feed.updates().size(), 1);
+  EXPECT_EQ(feed.updates()[0].price_, 99);
+  EXPECT_EQ(feed.updates()[0].size_, 0);
+}
+
+TYPED_TEST(DepthFeedTest, SnapshotListsBestLevelsFirst)
+{
+  this->orderbook_.addOrder(OrderType::GoodTillCancel, OrderId{1}, Side::Sell,
+                            Price{102}, Size{1});
+  this->orderbook_.addOrder(OrderType::GoodTillCancel, OrderId{2}, Side::Sell,
+                            Price{100}, Size{2});
+  this->orderbook_.addOrder(OrderType::GoodTillCancel, OrderId{3}, Side::Sell,
+                            Price{101}, Size{3});
+  this->orderbook_.addOrder(OrderType::GoodTillCancel, OrderId{4}, Side::Buy,
+                            Price{98}, Size{4});
+  this->orderbook_.addOrder(OrderType::GoodTillCancel, OrderId{5}, Side::Buy,
+                            Price{99}, Size{5});
+  this->orderbook_.addOrder(OrderType::GoodTillCancel, OrderId{6}, Side::Buy,
+                            Price{99}, Size{6});
+
+  Levels asks;
+  this->orderbook_.snapshotDepth(Side::Sell, 2, [&](Price price, Size size)
+                                 { asks.emplace_back(price, size); });
+  EXPECT_EQ(asks, (Levels{{100, 2}, {101, 3}}));
+
+  Levels bids;
+  this->orderbook_.snapshotDepth(Side::Buy, 10, [&](Price price, Size size)
+                                 { bids.emplace_back(price, size); });
+  EXPECT_EQ(bids, (Levels{{99, 11}, {98, 4}}));
+}
@@ -0,0 +1,68 @@
+#include <gtest/gtest.h>
+
+#include "orderbook/engine.h"
+#include "orderbook/orderbook.h"
+
+using EngineBook = OrderBook<MapLevelPolicy, IntrusiveOrderPolicy,
+                             PoolOrderAllocator, FlatOrderIndex>;
+
+namespace
+{
+Command add(SymbolId symbol, OrderId orderId, Side side, Price price,
+            Size volume)
+{
+  return Command{CommandType::Add, OrderType::GoodTillCancel, side, symbol,
+                 orderId, price, volume};
+}
+} // namespace
+
+TEST(MatchingEngineTest, KeepsOneBookPerSymbol)
+{
+  MatchingEngine<EngineBook> engine{3, 16};
+
+  for (SymbolId symbol = 0; symbol < 50; ++symbol)
+  {
+    engine.submit(add(symbol, OrderId{1}, Side::Sell, Price{100}, Size{10}));
+    engine.submit(add(symbol, OrderId{2}, Side::Buy, Price{100}, Size{4}));
+  }
+  engine.submit(Command{CommandType::Cancel, OrderType::GoodTillCancel,
+                        Side::Sell, SymbolId{7}, OrderId{1}, Price{}, Size{}});
+  engine.submit(Command{CommandType::Modify, OrderType::GoodTillCancel,
+                        Side::Buy, SymbolId{8}, OrderId{1}, Price{99},
+                        Size{5}});
+  engine.drain();
+
+  EXPECT_EQ(engine.trades(), 50);
+  EXPECT_EQ(engine.find(SymbolId{50}), nullptr);
+
+  ASSERT_NE(engine.find(SymbolId{7}), nullptr);
+  EXPECT_TRUE(engine.find(SymbolId{7})->empty());
+
+  ASSERT_NE(engine.find(SymbolId{8}), nullptr);
+  EXPECT_TRUE(engine.find(SymbolId{8})->canFullyFill(Side::Sell, Price{99},
+                                                     Size{5}));
+  EXPECT_FALSE(engine.find(SymbolId{8})->canFullyFill(Side::Buy, Price{200},
+                                                      Size{1}));
+
+  ASSERT_NE(engine.find(SymbolId{9}), nullptr);
+  EXPECT_TRUE(engine.find(SymbolId{9})->canFullyFill(Side::Buy, Price{100},
+                                                     Size{6}));
+}
+
+TEST(MatchingEngineTest, SpreadsSymbolsOverShards)
+{
+  MatchingEngine<EngineBook> engine{4};
+
+  std::size_t perShard[4] = {};
+  for (SymbolId symbol = 0; symbol < 4000; ++symbol)
+  {
+    auto shard = engine.shardOf(symbol);
+    ASSERT_LT(shard, 4);
+    ++perShard[shard];
+  }
+
+  for (auto count : perShard)
+  {
+    EXPECT_GT(count, 800);
+  }
+}
@@ -0,0 +1,78 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "orderbook/expiry_index.h"
+
+namespace
+{
+std::vector<OrderId> ids(const std::vector<OrderPointer> &orders)
+{
+  std::vector<OrderId> result;
+  for (auto order : orders)
+  {
+    result.push_back(order->getOrderId());
+  }
+  std::sort(result.begin(), result.end());
+  return result;
+}
+} // namespace
+
+TEST(ExpiryIndexTest, TakesOnlyOrdersDue)
+{
+  std::vector<Order> orders;
+  for (OrderId id = 0; id < 6; ++id)
+  {
+    orders.emplace_back(OrderType::GoodForDay, id, Side::Buy, Price{100},
+                        Size{10});
+  }
+
+  ExpiryIndex index;
+  index.insert(&orders[0], 100);
+  index.insert(&orders[1], 200);
+  index.insert(&orders[2], 100);
+  index.insert(&orders[3], 300);
+  index.insert(&orders[4], 200);
+  EXPECT_EQ(index.size(), 5);
+
+  std::vector<OrderPointer> expired;
+  index.take(99, expired);
+  EXPECT_TRUE(expired.empty());
+
+  index.take(200, expired);
+  EXPECT_EQ(ids(expired), (std::vector<OrderId>{0, 1, 2, 4}));
+  EXPECT_EQ(index.size(), 1);
+
+  expired.clear();
+  index.take(1000, expired);
+  EXPECT_EQ(ids(expired), (std::vector<OrderId>{3}));
+  EXPECT_TRUE(index.empty());
+}
+
+TEST(ExpiryIndexTest, EraseKeepsBucketDense)
+{
+  std::vector<Order> orders;
+  for (OrderId id = 0; id < 4; ++id)
+  {
+    orders.emplace_back(OrderType::GoodForDay, id, Side::Sell, Price{100},
+                        Size{10});
+  }
+
+  ExpiryIndex index;
+  for (auto &order : orders)
+  {
+    index.insert(&order, 100);
+  }
+
+  // The last order moves into the first's place and must still be found
+  index.erase(&orders[0]);
+  index.erase(&orders[3]);
+  index.erase(&orders[3]);
+  EXPECT_EQ(index.size(), 2);
+
+  std::vector<OrderPointer> expired;
+  index.take(100, expired);
+  EXPECT_EQ(ids(expired), (std::vector<OrderId>{1, 2}));
+  EXPECT_TRUE(index.empty());
+}
@@ -0,0 +1,50 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+#include "orderbook/fill_kernel.h"
+
+TEST(FillKernelTest, SumsEveryLength)
+{
+  std::vector<Size> sizes(40);
+  for (std::size_t i = 0; i < sizes.size(); ++i)
+  {
+    sizes[i] = i + 1;
+  }
+
+  for (std::size_t count = 0; count <= sizes.size(); ++count)
+  {
+    EXPECT_EQ(sumSizes(sizes.data(), count), count * (count + 1) / 2)
+        << "count " << count;
+  }
+}
+
+TEST(FillKernelTest, HugeSizesWrapAsScalar)
+{
+  std::vector<Size> sizes(33, Size{1} << 62);
+  EXPECT_EQ(sumSizes(sizes.data(), sizes.size()),
+            sumSizesScalar(sizes.data(), sizes.size()));
+}
+
+TEST(FillKernelTest, MatchesScalar)
+{
+  std::mt19937_64 rng{42};
+
+  for (int round = 0; round < 2000; ++round)
+  {
+    std::size_t count = rng() % 100;
+    std::vector<Size> sizes(count);
+    for (auto &size : sizes)
+    {
+      // Tombstones among small orders
+      size = rng() % 8 == 0 ? 0 : rng() % 50 + 1;
+    }
+
+    // Unaligned starts too
+    std::size_t offset = count > 0 ? rng() % count : 0;
+    ASSERT_EQ(sumSizes(sizes.data() + offset, count - offset),
+              sumSizesScalar(sizes.data() + offset, count - offset))
+        << "round " << round;
+  }
+}
@@ -0,0 +1,198 @@
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "orderbook/journal.h"
+#include "orderbook/orderbook.h"
+
+using JournaledBook =
+    OrderBook<MapLevelPolicy, IntrusiveOrderPolicy, PoolOrderAllocator,
+              FlatOrderIndex, NullDepthListener, NullOrderEventListener,
+              MappedJournal>;
+using ReplayBook = OrderBook<ArrayLevelPolicy, IntrusiveOrderPolicy,
+                             PoolOrderAllocator, FlatOrderIndex>;
+
+namespace
+{
+using Levels = std::vector<std::pair<Price, Size>>;
+
+template <typename Book> Levels depth(const Book &book, Side side)
+{
+  Levels levels;
+  book.snapshotDepth(side, 100, [&](Price price, Size size)
+                     { levels.emplace_back(price, size); });
+  return levels;
+}
+
+class JournalTest : public testing::Test
+{
+protected:
+  void SetUp() override { std::filesystem::remove(path_); }
+  void TearDown() override { std::filesystem::remove(path_); }
+
+  std::string path_ =
+      (std::filesystem::temp_directory_path() / "orderbook_journal_test.bin")
+          .string();
+};
+} // namespace
+
+TEST_F(JournalTest, ReplayRebuildsBook)
+{
+  Levels bids;
+  Levels asks;
+  {
+    JournaledBook book{NullDepthListener{}, NullOrderEventListener{},
+                       MappedJournal{path_, 64, 4}};
+
+    book.addOrder(OrderType::GoodTillCancel, OrderId{1}, Side::Sell,
+                  Price{101}, Size{10});
+    book.addOrder(OrderType::GoodTillCancel, OrderId{2}, Side::Buy,
+                  Price{99}, Size{10});
+    book.addOrder(OrderType::GoodTillCancel, OrderId{2}, Side::Buy,
+                  Price{98}, Size{10});
+    book.addOrder(OrderType::GoodTillCancel, OrderId{3}, Side::Buy,
+                  Price{101}, Size{4});
+    book.cancelOrder(OrderId{99});
+    book.modifyOrder(OrderType::GoodTillCancel, OrderId{2}, Side::Buy,
+                     Price{100}, Size{7});
+    book.addOrder(OrderType::GoodTillCancel, OrderId{4}, Side::Sell,
+                  Price{102}, Size{5});
+    book.cancelOrder(OrderId{4});
+
+    // Duplicate add and unknown cancel are not journaled
+    EXPECT_EQ(book.journal().size(), 6);
+
+    bids = depth(book, Side::Buy);
+    asks = depth(book, Side::Sell);
+  }
+
+  ReplayBook replayed;
+  EXPECT_EQ(MappedJournal::replayInto(path_, replayed), 6);
+  EXPECT_EQ(depth(replayed, Side::Buy), bids);
+  EXPECT_EQ(depth(replayed, Side::Sell), asks);
+  EXPECT_EQ(bids, (Levels{{100, 7}}));
+  EXPECT_EQ(asks, (Levels{{101, 6}}));
+}
+
+TEST_F(JournalTest, ReopenAppendsAfterLastRecord)
+{
+  Command command{CommandType::Add, OrderType::GoodTillCancel, Side::Buy,
+                  SymbolId{}, OrderId{1}, Price{100}, Size{10}};
+  {
+    MappedJournal journal{path_, 8, 0};
+    journal.record(command);
+    journal.record(command);
+  }
+  {
+    MappedJournal journal{path_, 8};
+    EXPECT_EQ(journal.size(), 2);
+    command.orderId_ = 3;
+    journal.record(command);
+  }
+
+  std::vector<OrderId> ids;
+  EXPECT_EQ(MappedJournal::replay(path_, [&](const Command &replayed)
+                                  { ids.push_back(replayed.orderId_); }),
+            3);
+  EXPECT_EQ(ids, (std::vector<OrderId>{1, 1, 3}));
+
+  MappedJournal journal{path_, 3};
+  EXPECT_EQ(journal.capacity(), 8);
+  for (int i = 0; i < 5; ++i)
+  {
+    journal.record(command);
+  }
+  EXPECT_THROW(journal.record(command), std::runtime_error);
+}
+
+TEST_F(JournalTest, TornRecordEndsJournal)
+{
+  Command command{CommandType::Add, OrderType::GoodTillCancel, Side::Buy,
+                  SymbolId{}, OrderId{1}, Price{100}, Size{10}};
+  {
+    MappedJournal journal{path_, 8, 0};
+    for (OrderId id = 1; id <= 3; ++id)
+    {
+      command.orderId_ = id;
+      journal.record(command);
+    }
+  }
+
+  // Leave the second record's sequence in place over a command that never
+  // made it to disk
+  {
+    std::fstream file{path_, std::ios::in | std::ios::out | std::ios::binary};
+    file.seekp(64 + sizeof(JournalRecord) + offsetof(JournalRecord, command_) +
+               offsetof(Command, orderId_));
+    OrderId stale = 7;
+    file.write(reinterpret_cast<const char *>(&stale), sizeof(stale));
+  }
+
+  std::vector<OrderId> ids;
+  EXPECT_EQ(MappedJournal::replay(path_, [&](const Command &replayed)
+                                  { ids.push_back(replayed.orderId_); }),
+            1);
+  EXPECT_EQ(ids, (std::vector<OrderId>{1}));
+
+  MappedJournal journal{path_, 8};
+  EXPECT_EQ(journal.size(), 1);
+}
+
+TEST_F(JournalTest, BatchCancelIsRefusedWholeWhenJournalIsFull)
+{
+  JournaledBook book{NullDepthListener{}, NullOrderEventListener{},
+                     MappedJournal{path_, 4}};
+
+  book.addOrder(OrderType::GoodTillCancel, OrderId{1}, Side::Buy, Price{99},
+                Size{10});
+  book.addOrder(OrderType::GoodTillCancel, OrderId{2}, Side::Buy, Price{99},
+                Size{5});
+  book.addOrder(OrderType::GoodTillCancel, OrderId{3}, Side::Buy, Price{98},
+                Size{7});
+
+  // Room for one more record, not two
+  std::vector<OrderId> both{1, 3};
+  EXPECT_THROW(book.cancelOrders(both), std::runtime_error);
+  EXPECT_EQ(book.journal().size(), 3);
+  EXPECT_EQ(depth(book, Side::Buy), (Levels{{99, 15}, {98, 7}}));
+
+  // Order 1 is still indexed, so can still be cancelled. Unknown ids need
+  // no room in the journal
+  std::vector<OrderId> one{1, 42};
+  EXPECT_EQ(book.cancelOrders(one), 1);
+  EXPECT_EQ(book.journal().size(), 4);
+  EXPECT_EQ(depth(book, Side::Buy), (Levels{{99, 5}, {98, 7}}));
+}
+
+TEST_F(JournalTest, ExpiryIsRefusedWholeWhenJournalIsFull)
+{
+  JournaledBook book{NullDepthListener{}, NullOrderEventListener{},
+                     MappedJournal{path_, 5}};
+  book.setSessionClose(Timestamp{1000});
+
+  book.addOrder(OrderType::GoodForDay, OrderId{1}, Side::Buy, Price{99},
+                Size{10});
+  book.addOrder(OrderType::GoodForDay, OrderId{2}, Side::Buy, Price{98},
+                Size{5});
+  book.addOrder(OrderType::GoodForDay, OrderId{3}, Side::Sell, Price{101},
+                Size{7});
+
+  // Room for two more records, not three
+  EXPECT_THROW(book.expire(Timestamp{1000}), std::runtime_error);
+  EXPECT_EQ(book.journal().size(), 3);
+  EXPECT_EQ(depth(book, Side::Buy), (Levels{{99, 10}, {98, 5}}));
+  EXPECT_EQ(depth(book, Side::Sell), (Levels{{101, 7}}));
+
+  // The orders are still indexed and queued
+  std::vector<OrderId> bids{1, 2};
+  EXPECT_EQ(book.cancelOrders(bids), 2);
+  EXPECT_EQ(book.journal().size(), 5);
+  EXPECT_TRUE(depth(book, Side::Buy).empty());
+  EXPECT_EQ(depth(book, Side::Sell), (Levels{{101, 7}}));
+}
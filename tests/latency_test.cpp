@@ -0,0 +1,110 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+
+#include "orderbook/latency.h"
+#include "orderbook/orderbook.h"
+
+using TimedBook =
+    OrderBook<MapLevelPolicy, IntrusiveOrderPolicy, PoolOrderAllocator,
+              FlatOrderIndex, NullDepthListener, NullOrderEventListener,
+              NullJournal, TscLatencyRecorder>;
+
+TEST(LatencyHistogramTest, SmallValuesAreExact)
+{
+  LatencyHistogram histogram;
+  for (std::uint64_t ticks = 1; ticks <= 10; ++ticks)
+  {
+    histogram.record(ticks);
+  }
+
+  EXPECT_EQ(histogram.count(), 10);
+  EXPECT_EQ(histogram.max(), 10);
+  EXPECT_EQ(histogram.percentile(0.5), 5);
+  EXPECT_EQ(histogram.percentile(0.9), 9);
+  EXPECT_EQ(histogram.percentile(1.0), 10);
+}
+
+TEST(LatencyHistogramTest, LargeValuesStayWithinBucketWidth)
+{
+  LatencyHistogram histogram;
+  for (std::uint64_t i = 0; i < 999; ++i)
+  {
+    histogram.record(100);
+  }
+  histogram.record(100000);
+
+  auto p50 = histogram.percentile(0.5);
+  EXPECT_GE(p50, 100);
+  EXPECT_LE(p50, 100 + 100 / LatencyHistogram::subBuckets_);
+
+  auto p999 = histogram.percentile(0.999);
+  EXPECT_EQ(p999, p50);
+  EXPECT_EQ(histogram.percentile(1.0), 100000);
+}
+
+TEST(LatencyHistogramTest, HugeValuesShareTopBucket)
+{
+  LatencyHistogram histogram;
+  histogram.record(UINT64_MAX);
+
+  EXPECT_EQ(histogram.count(), 1);
+  EXPECT_EQ(histogram.percentile(0.5), UINT64_MAX);
+}
+
+TEST(LatencyHistogramTest, MergeAndReset)
+{
+  LatencyHistogram a;
+  LatencyHistogram b;
+  a.record(3);
+  b.record(7);
+  b.record(9);
+
+  a.merge(b);
+  EXPECT_EQ(a.count(), 3);
+  EXPECT_EQ(a.max(), 9);
+  EXPECT_EQ(a.percentile(0.5), 7);
+
+  a.reset();
+  EXPECT_EQ(a.count(), 0);
+  EXPECT_EQ(a.percentile(0.5), 0);
+}
+
+TEST(TscLatencyRecorderTest, RecordsEachOperationByOrderType)
+{
+  TimedBook book;
+
+  book.addOrder(OrderType::GoodTillCancel, OrderId{1}, Side::Buy, Price{100},
+                Size{10});
+  book.addOrder(OrderType::AllOrNone, OrderId{2}, Side::Buy, Price{99},
+                Size{10});
+  book.addOrder(OrderType::FillAndKill, OrderId{3}, Side::Sell, Price{100},
+                Size{4});
+  book.modifyOrder(OrderType::GoodTillCancel, OrderId{1}, Side::Buy,
+                   Price{101}, Size{5});
+  book.cancelOrder(OrderId{2});
+  book.cancelOrder(OrderId{42});
+
+  const auto &snapshot = book.latencyRecorder().snapshot();
+  EXPECT_EQ(snapshot.histogram(BookOperation::Add).count(), 3);
+  EXPECT_EQ(
+      snapshot.histogram(BookOperation::Add, OrderType::GoodTillCancel)
+          .count(),
+      1);
+  EXPECT_EQ(
+      snapshot.histogram(BookOperation::Add, OrderType::FillAndKill).count(),
+      1);
+  EXPECT_EQ(
+      snapshot.histogram(BookOperation::Modify, OrderType::GoodTillCancel)
+          .count(),
+      1);
+
+  // The unknown id is not recorded
+  EXPECT_EQ(snapshot.histogram(BookOperation::Cancel).count(), 1);
+  EXPECT_EQ(
+      snapshot.histogram(BookOperation::Cancel, OrderType::AllOrNone).count(),
+      1);
+
+  book.latencyRecorder().reset();
+  EXPECT_EQ(snapshot.histogram(BookOperation::Add).count(), 0);
+}
@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+#include "orderbook/level_bitmap.h"
+
+TEST(LevelBitmapTest, EmptyBitmapHasNoSlots)
+{
+  LevelBitmap bitmap{1000};
+
+  EXPECT_TRUE(bitmap.none());
+  EXPECT_EQ(bitmap.first(), LevelBitmap::npos);
+  EXPECT_EQ(bitmap.last(), LevelBitmap::npos);
+  EXPECT_EQ(bitmap.findNext(500), LevelBitmap::npos);
+  EXPECT_EQ(bitmap.findPrev(500), LevelBitmap::npos);
+}
+
+TEST(LevelBitmapTest, FindsAcrossLayers)
+{
+  LevelBitmap bitmap{1 << 20};
+
+  bitmap.set(3);
+  bitmap.set(700000);
+  bitmap.set((1 << 20) - 1);
+
+  EXPECT_FALSE(bitmap.none());
+  EXPECT_EQ(bitmap.first(), 3);
+  EXPECT_EQ(bitmap.last(), (1 << 20) - 1);
+  EXPECT_EQ(bitmap.findNext(4), 700000);
+  EXPECT_EQ(bitmap.findNext(700001), (1 << 20) - 1);
+  EXPECT_EQ(bitmap.findPrev(699999), 3);
+  EXPECT_EQ(bitmap.findPrev(2), LevelBitmap::npos);
+
+  bitmap.reset(700000);
+  EXPECT_EQ(bitmap.findNext(4), (1 << 20) - 1);
+  EXPECT_FALSE(bitmap.test(700000));
+
+  bitmap.reset(3);
+  bitmap.reset((1 << 20) - 1);
+  EXPECT_TRUE(bitmap.none());
+}
+
+TEST(LevelBitmapTest, MatchesLinearScan)
+{
+  constexpr std::size_t size = 300000;
+
+  LevelBitmap bitmap{size};
+  std::vector<bool> reference(size);
+  std::mt19937_64 rng{42};
+
+  for (int step = 0; step < 20000; ++step)
+  {
+    std::size_t i = rng() % size;
+    if (rng() % 3 == 0)
+    {
+      bitmap.reset(i);
+      reference[i] = false;
+    }
+    else
+    {
+      bitmap.set(i);
+      reference[i] = true;
+    }
+
+    std::size_t probe = rng() % size;
+
+    std::size_t next = probe;
+    while (next < size && !reference[next])
+      ++next;
+
+    std::size_t prev = probe + 1;
+    while (prev > 0 && !reference[prev - 1])
+      --prev;
+
+    ASSERT_EQ(bitmap.findNext(probe), next == size ? LevelBitmap::npos : next);
+    ASSERT_EQ(bitmap.findPrev(probe),
+              prev == 0 ? LevelBitmap::npos : prev - 1);
+  }
+}
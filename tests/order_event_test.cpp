@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+
+#include <unordered_map>
+
+#include "orderbook/order_event.h"
+#include "orderbook/orderbook.h"
+
+template <template <typename, typename> class LevelContainer>
+using EventBook =
+    OrderBook<LevelContainer, IntrusiveOrderPolicy, PoolOrderAllocator,
+              std::unordered_map<OrderId, OrderPointer>, NullDepthListener,
+              OrderEventBuffer>;
+
+using EventBookPolicies =
+    ::testing::Types<EventBook<MapLevelPolicy>, EventBook<VectorLevelPolicy>,
+                     EventBook<ListLevelPolicy>, EventBook<ArrayLevelPolicy>>;
+
+template <typename OrderBookPolicy> class OrderEventTest : public testing::Test
+{
+public:
+  void expectEvent(std::size_t index, OrderEventType type, Side side,
+                   OrderId orderId, Price price, Size size) const
+  {
+    const auto &events = orderbook_.orderEventListener().events();
+    ASSERT_LT(index, events.size());
+    EXPECT_EQ(events[index].type_, type);
+    EXPECT_EQ(events[index].side_, side);
+    EXPECT_EQ(events[index].orderId_, orderId);
+    EXPECT_EQ(events[index].price_, price);
+    EXPECT_EQ(events[index].size_, size);
+  }
+
+  OrderBookPolicy orderbook_;
+};
+
+TYPED_TEST_SUITE(OrderEventTest, EventBookPolicies);
+
+TYPED_TEST(OrderEventTest, RestingOrderLifecycle)
+{
+  this->orderbook_.addOrder(OrderType::GoodTillCancel, OrderId{1}, Side::Sell,
+                            Price{100}, Size{10});
+  this->orderbook_.addOrder(OrderType::GoodTillCancel, OrderId{2}, Side::Sell,
+                            Price{101}, Size{10});
+  this->orderbook_.addOrder(OrderType::GoodTillCancel, OrderId{3}, Side::Buy,
+                            Price{101}, Size{25});
+  this->orderbook_.cancelOrder(OrderId{3});
+
+  EXPECT_EQ(this->orderbook_.orderEventListener().count(), 8);
+  this->expectEvent(0, OrderEventType::Add, Side::Sell, 1, 100, 10);
+  this->expectEvent(1, OrderEventType::Add, Side::Sell, 2, 101, 10);
+  this->expectEvent(2, OrderEventType::Execute, Side::Sell, 1, 100, 10);
+  this->expectEvent(3, OrderEventType::Delete, Side::Sell, 1, 100, 0);
+  this->expectEvent(4, OrderEventType::Execute, Side::Sell, 2, 101, 10);
+  this->expectEvent(5, OrderEventType::Delete, Side::Sell, 2, 101, 0);
+  this->expectEvent(6, OrderEventType::Add, Side::Buy, 3, 101, 5);
+  this->expectEvent(7, OrderEventType::Delete, Side::Buy, 3, 101, 5);
+}
+
+TYPED_TEST(OrderEventTest, ModifyAndPartialFill)
+{
+  this->orderbook_.addOrder(OrderType::GoodTillCancel, OrderId{1}, Side::Buy,
+                            Price{100}, Size{10});
+  this->orderbook_.modifyOrder(OrderType::GoodTillCancel, OrderId{1},
+                               Side::Buy, Price{99}, Size{8});
+  this->orderbook_.addOrder(OrderType::FillAndKill, OrderId{2}, Side::Sell,
+                            Price{99}, Size{3});
+
+  EXPECT_EQ(this->orderbook_.orderEventListener().count(), 4);
+  this->expectEvent(0, OrderEventType::Add, Side::Buy, 1, 100, 10);
+  this->expectEvent(1, OrderEventType::Delete, Side::Buy, 1, 100, 10);
+  this->expectEvent(2, OrderEventType::Add, Side::Buy, 1, 99, 8);
+  this->expectEvent(3, OrderEventType::Execute, Side::Buy, 1, 99, 3);
+}
+
+TYPED_TEST(OrderEventTest, AmendDownReportsReduce)
+{
+  this->orderbook_.addOrder(OrderType::AllOrNone, OrderId{1}, Side::Sell,
+                            Price{100}, Size{20});
+  this->orderbook_.modifyOrder(OrderType::AllOrNone, OrderId{1}, Side::Sell,
+                               Price{100}, Size{5});
+
+  // Fits the amended AllOrNone order, which the original would not
+  auto trades = this->orderbook_.addOrder(OrderType::FillOrKill, OrderId{2},
+                                          Side::Buy, Price{100}, Size{5});
+  EXPECT_EQ(trades.size(), 1);
+
+  EXPECT_EQ(this->orderbook_.orderEventListener().count(), 4);
+  this->expectEvent(0, OrderEventType::Add, Side::Sell, 1, 100, 20);
+  this->expectEvent(1, OrderEventType::Reduce, Side::Sell, 1, 100, 15);
+  this->expectEvent(2, OrderEventType::Execute, Side::Sell, 1, 100, 5);
+  this->expectEvent(3, OrderEventType::Delete, Side::Sell, 1, 100, 0);
+}
+
+TEST(OrderEventBufferTest, CountsOverflow)
+{
+  OrderEventBuffer buffer{1};
+
+  buffer.onEvent(OrderEvent{OrderEventType::Add, Side::Buy, 1, 100, 10});
+  buffer.onEvent(OrderEvent{OrderEventType::Delete, Side::Buy, 1, 100, 10});
+
+  EXPECT_EQ(buffer.count(), 2);
+  EXPECT_TRUE(buffer.overflowed());
+  ASSERT_EQ(buffer.events().size(), 1);
+  EXPECT_EQ(buffer.events()[0].type_, OrderEventType::Add);
+
+  buffer.clear();
+  EXPECT_FALSE(buffer.overflowed());
+  EXPECT_TRUE(buffer.events().empty());
+}
@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <unordered_map>
+
+#include "orderbook/order_index.h"
+
+TEST(FlatOrderMapTest, InsertFindErase)
+{
+  FlatOrderMap<int> map;
+
+  EXPECT_TRUE(map.empty());
+  EXPECT_FALSE(map.contains(OrderId{1}));
+  EXPECT_EQ(map.find(OrderId{1}), map.end());
+
+  map[OrderId{1}] = 10;
+  auto [it, inserted] = map.try_emplace(OrderId{2}, 20);
+  EXPECT_TRUE(inserted);
+  EXPECT_EQ(it->second, 20);
+  EXPECT_FALSE(map.try_emplace(OrderId{2}, 30).second);
+
+  EXPECT_EQ(map.size(), 2);
+  EXPECT_EQ(map.find(OrderId{1})->second, 10);
+  EXPECT_EQ(map[OrderId{2}], 20);
+
+  map.erase(map.find(OrderId{1}));
+  EXPECT_FALSE(map.contains(OrderId{1}));
+  EXPECT_EQ(map.erase(OrderId{1}), 0);
+  EXPECT_EQ(map.erase(OrderId{2}), 1);
+  EXPECT_TRUE(map.empty());
+}
+
+TEST(FlatOrderMapTest, ReserveAvoidsRehash)
+{
+  FlatOrderMap<int> map;
+  map.reserve(1000);
+  auto capacity = map.capacity();
+
+  for (OrderId id = 0; id < 1000; ++id)
+  {
+    map[id] = static_cast<int>(id);
+  }
+
+  EXPECT_EQ(map.capacity(), capacity);
+}
+
+TEST(FlatOrderMapTest, MatchesUnorderedMap)
+{
+  FlatOrderMap<OrderId> map;
+  std::unordered_map<OrderId, OrderId> reference;
+  std::mt19937_64 rng{7};
+
+  for (int step = 0; step < 100000; ++step)
+  {
+    OrderId key = rng() % 5000;
+
+    switch (rng() % 3)
+    {
+    case 0:
+      map[key] = key * 3;
+      reference[key] = key * 3;
+      break;
+    case 1:
+      ASSERT_EQ(map.erase(key), reference.erase(key));
+      break;
+    default:
+      ASSERT_EQ(map.contains(key), reference.contains(key));
+      if (reference.contains(key))
+      {
+        ASSERT_EQ(map.find(key)->second, reference[key]);
+      }
+    }
+  }
+
+  ASSERT_EQ(map.size(), reference.size());
+
+  std::size_t visited = 0;
+  for (const auto &[key, value] : map)
+  {
+    ASSERT_EQ(reference.at(key), value);
+    ++visited;
+  }
+  EXPECT_EQ(visited, reference.size());
+}
@@ -1,17 +1,56 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <memory>
+#include <random>
+#include <utility>
+#include <vector>
+
 #include "orderbook/orderbook.h"
 
 using OrderBookPolicies =
     ::testing::Types<OrderBook<MapLevelPolicy, DequeOrderPolicy>,
                      OrderBook<MapLevelPolicy, ListOrderPolicy>,
                      OrderBook<MapLevelPolicy, VectorOrderPolicy>,
+                     OrderBook<MapLevelPolicy, IntrusiveOrderPolicy>,
                      OrderBook<VectorLevelPolicy, DequeOrderPolicy>,
                      OrderBook<VectorLevelPolicy, ListOrderPolicy>,
                      OrderBook<VectorLevelPolicy, VectorOrderPolicy>,
+                     OrderBook<VectorLevelPolicy, IntrusiveOrderPolicy>,
                      OrderBook<ListLevelPolicy, DequeOrderPolicy>,
                      OrderBook<ListLevelPolicy, ListOrderPolicy>,
-                     OrderBook<ListLevelPolicy, VectorOrderPolicy>>;
+                     OrderBook<ListLevelPolicy, VectorOrderPolicy>,
+                     OrderBook<ListLevelPolicy, IntrusiveOrderPolicy>,
+                     OrderBook<ArrayLevelPolicy, DequeOrderPolicy>,
+                     OrderBook<ArrayLevelPolicy, ListOrderPolicy>,
+                     OrderBook<ArrayLevelPolicy, VectorOrderPolicy>,
+                     OrderBook<ArrayLevelPolicy, IntrusiveOrderPolicy>,
+                     OrderBook<MapLevelPolicy, ColumnarOrderPolicy>,
+                     OrderBook<ListLevelPolicy, ColumnarOrderPolicy>,
+                     OrderBook<MapLevelPolicy, TombstoneDequeOrderPolicy>,
+                     OrderBook<VectorLevelPolicy, TombstoneVectorOrderPolicy>,
+                     OrderBook<ArrayLevelPolicy, TombstoneVectorOrderPolicy>,
+                     OrderBook<ChunkedLevelPolicy, DequeOrderPolicy>,
+                     OrderBook<ChunkedLevelPolicy, ListOrderPolicy>,
+                     OrderBook<ChunkedLevelPolicy, IntrusiveOrderPolicy>,
+                     OrderBook<ChunkedLevelPolicy, ColumnarOrderPolicy>,
+                     OrderBook<ChunkedLevelPolicy, TombstoneVectorOrderPolicy>,
+                     OrderBook<MapLevelPolicy, IntrusiveOrderPolicy,
+                               PoolOrderAllocator>,
+                     OrderBook<VectorLevelPolicy, DequeOrderPolicy,
+                               PoolOrderAllocator>,
+                     OrderBook<ListLevelPolicy, ListOrderPolicy,
+                               PoolOrderAllocator>,
+                     OrderBook<MapLevelPolicy, VectorOrderPolicy,
+                               HeapOrderAllocator, FlatOrderIndex>,
+                     OrderBook<ArrayLevelPolicy, IntrusiveOrderPolicy,
+                               PoolOrderAllocator, FlatOrderIndex>,
+                     OrderBook<ArrayLevelPolicy, ColumnarOrderPolicy,
+                               PoolOrderAllocator, FlatOrderIndex>,
+                     OrderBook<ChunkedLevelPolicy, IntrusiveOrderPolicy,
+                               PoolOrderAllocator, FlatOrderIndex>>;
 
 template <typename OrderBookPolicy> class OrderBookTest : public testing::Test
 {
@@ -154,6 +193,37 @@ TYPED_TEST(OrderBookTest, FOKPriceTooHigh)
   EXPECT_FALSE(this->orderbook_.empty());
 }
 
+TYPED_TEST(OrderBookTest, FOKSkipsOversizedAON)
+{
+  this->orderbook_.addOrder(OrderType::GoodTillCancel, OrderId{1}, Side::Sell,
+                            Price{100}, Size{5});
+  this->orderbook_.addOrder(OrderType::AllOrNone, OrderId{2}, Side::Sell,
+                            Price{100}, Size{8});
+
+  EXPECT_FALSE(this->orderbook_.canFullyFill(Side::Buy, Price{100}, Size{10}));
+  EXPECT_TRUE(this->orderbook_.canFullyFill(Side::Buy, Price{100}, Size{13}));
+
+  this->orderbook_.addOrder(OrderType::AllOrNone, OrderId{3}, Side::Sell,
+                            Price{101}, Size{4});
+  this->orderbook_.addOrder(OrderType::GoodTillCancel, OrderId{4}, Side::Sell,
+                            Price{101}, Size{5});
+
+  EXPECT_TRUE(this->orderbook_.canFullyFill(Side::Buy, Price{101}, Size{10}));
+
+  auto trades = this->orderbook_.addOrder(OrderType::FillOrKill, OrderId{5},
+                                          Side::Buy, Price{101}, Size{10});
+
+  ASSERT_EQ(trades.size(), 3);
+  EXPECT_EQ(trades[0].getAsk().orderId_, 1);
+  EXPECT_EQ(trades[1].getAsk().orderId_, 3);
+  EXPECT_EQ(trades[2].getAsk().orderId_, 4);
+  EXPECT_EQ(trades[2].getAsk().size_, 1);
+
+  this->orderbook_.cancelOrder(OrderId{2});
+  EXPECT_FALSE(this->orderbook_.canFullyFill(Side::Buy, Price{101}, Size{5}));
+  EXPECT_TRUE(this->orderbook_.canFullyFill(Side::Buy, Price{101}, Size{4}));
+}
+
 TYPED_TEST(OrderBookTest, FAK)
 {
   this->orderbook_.addOrder(OrderType::GoodTillCancel, OrderId{1}, Side::Sell,
@@ -188,6 +258,107 @@ TYPED_TEST(OrderBookTest, AONRestingLogic)
   EXPECT_EQ(trades2[0].getAsk().orderId_, 1);
 }
 
+TYPED_TEST(OrderBookTest, FillOrKillCountsQueueAheadOfAON)
+{
+  // 27 lots live ahead of the AllOrNone order among cancelled ones, 5 behind
+  for (OrderId id = 1; id <= 40; ++id)
+  {
+    this->orderbook_.addOrder(OrderType::GoodTillCancel, id, Side::Sell,
+                              Price{100}, Size{1});
+  }
+  for (OrderId id = 3; id <= 40; id += 3)
+  {
+    this->orderbook_.cancelOrder(id);
+  }
+  this->orderbook_.addOrder(OrderType::AllOrNone, OrderId{41}, Side::Sell,
+                            Price{100}, Size{10});
+  for (OrderId id = 42; id <= 46; ++id)
+  {
+    this->orderbook_.addOrder(OrderType::GoodTillCancel, id, Side::Sell,
+                              Price{100}, Size{1});
+  }
+
+  EXPECT_TRUE(this->orderbook_
+                  .addOrder(OrderType::FillOrKill, OrderId{47}, Side::Buy,
+                            Price{100}, Size{36})
+                  .empty());
+
+  auto trades = this->orderbook_.addOrder(OrderType::FillOrKill, OrderId{48},
+                                          Side::Buy, Price{100}, Size{37});
+  Size filled = 0;
+  for (const auto &trade : trades)
+  {
+    filled += trade.getBid().size_;
+  }
+  EXPECT_EQ(filled, 37);
+  EXPECT_EQ(trades.size(), 28);
+  EXPECT_EQ(trades.back().getAsk().orderId_, 41);
+}
+
+TYPED_TEST(OrderBookTest, AONInterleavesWithQueue)
+{
+  this->orderbook_.addOrder(OrderType::GoodTillCancel, OrderId{1}, Side::Sell,
+                            Price{100}, Size{5});
+  this->orderbook_.addOrder(OrderType::AllOrNone, OrderId{2}, Side::Sell,
+                            Price{100}, Size{4});
+  this->orderbook_.addOrder(OrderType::GoodTillCancel, OrderId{3}, Side::Sell,
+                            Price{100}, Size{5});
+  this->orderbook_.addOrder(OrderType::AllOrNone, OrderId{4}, Side::Sell,
+                            Price{100}, Size{3});
+  this->orderbook_.addOrder(OrderType::GoodTillCancel, OrderId{5}, Side::Sell,
+                            Price{100}, Size{5});
+
+  auto trades = this->orderbook_.addOrder(OrderType::FillAndKill, OrderId{6},
+                                          Side::Buy, Price{100}, Size{12});
+
+  ASSERT_EQ(trades.size(), 3);
+  EXPECT_EQ(trades[0].getAsk().orderId_, 1);
+  EXPECT_EQ(trades[1].getAsk().orderId_, 2);
+  EXPECT_EQ(trades[1].getAsk().size_, 4);
+  EXPECT_EQ(trades[2].getAsk().orderId_, 3);
+  EXPECT_EQ(trades[2].getAsk().size_, 3);
+
+  // Order 4 no longer fits once order 3 has taken 2
+  auto trades2 = this->orderbook_.addOrder(
+      OrderType::FillAndKill, OrderId{7}, Side::Buy, Price{100}, Size{4});
+
+  ASSERT_EQ(trades2.size(), 2);
+  EXPECT_EQ(trades2[0].getAsk().orderId_, 3);
+  EXPECT_EQ(trades2[1].getAsk().orderId_, 5);
+  EXPECT_EQ(trades2[1].getAsk().size_, 2);
+
+  auto trades3 = this->orderbook_.addOrder(
+      OrderType::FillAndKill, OrderId{8}, Side::Buy, Price{100}, Size{6});
+
+  ASSERT_EQ(trades3.size(), 2);
+  EXPECT_EQ(trades3[0].getAsk().orderId_, 4);
+  EXPECT_EQ(trades3[1].getAsk().orderId_, 5);
+  EXPECT_TRUE(this->orderbook_.empty());
+}
+
+TYPED_TEST(OrderBookTest, FOKSeesAONAfterQueueAhead)
+{
+  this->orderbook_.addOrder(OrderType::GoodTillCancel, OrderId{1}, Side::Buy,
+                            Price{100}, Size{5});
+  this->orderbook_.addOrder(OrderType::GoodTillCancel, OrderId{2}, Side::Buy,
+                            Price{100}, Size{5});
+  this->orderbook_.addOrder(OrderType::AllOrNone, OrderId{3}, Side::Buy,
+                            Price{100}, Size{4});
+  this->orderbook_.addOrder(OrderType::AllOrNone, OrderId{4}, Side::Buy,
+                            Price{99}, Size{4});
+  this->orderbook_.addOrder(OrderType::GoodTillCancel, OrderId{5}, Side::Buy,
+                            Price{99}, Size{5});
+
+  // Only 1 is left for order 3 once the queue ahead of it has filled
+  EXPECT_TRUE(this->orderbook_.canFullyFill(Side::Sell, Price{100}, Size{10}));
+  EXPECT_FALSE(this->orderbook_.canFullyFill(Side::Sell, Price{100}, Size{11}));
+  EXPECT_TRUE(this->orderbook_.canFullyFill(Side::Sell, Price{100}, Size{14}));
+
+  // Order 4 is ahead of the queue at 99, so the 6 left for it is enough
+  EXPECT_TRUE(this->orderbook_.canFullyFill(Side::Sell, Price{99}, Size{20}));
+  EXPECT_FALSE(this->orderbook_.canFullyFill(Side::Sell, Price{99}, Size{24}));
+}
+
 TYPED_TEST(OrderBookTest, CancelOrder)
 {
   this->orderbook_.addOrder(OrderType::GoodTillCancel, OrderId{1}, Side::Buy,
@@ -216,6 +387,51 @@ TYPED_TEST(OrderBookTest, ModifyOrder)
   EXPECT_EQ(trades2[0].getBid().size_, 20);
 }
 
+TYPED_TEST(OrderBookTest, AmendDownKeepsPriority)
+{
+  this->orderbook_.addOrder(OrderType::GoodTillCancel, OrderId{1}, Side::Buy,
+                            Price{100}, Size{10});
+  this->orderbook_.addOrder(OrderType::GoodTillCancel, OrderId{2}, Side::Buy,
+                            Price{100}, Size{10});
+
+  auto trades = this->orderbook_.modifyOrder(
+      OrderType::GoodTillCancel, OrderId{1}, Side::Buy, Price{100}, Size{4});
+  EXPECT_TRUE(trades.empty());
+
+  std::vector<std::pair<Price, Size>> bids;
+  this->orderbook_.snapshotDepth(Side::Buy, 1, [&](Price price, Size size)
+                                 { bids.emplace_back(price, size); });
+  ASSERT_EQ(bids.size(), 1);
+  EXPECT_EQ(bids[0].second, 14);
+
+  auto trades2 = this->orderbook_.addOrder(
+      OrderType::GoodTillCancel, OrderId{3}, Side::Sell, Price{100}, Size{6});
+
+  ASSERT_EQ(trades2.size(), 2);
+  EXPECT_EQ(trades2[0].getBid().orderId_, 1);
+  EXPECT_EQ(trades2[0].getBid().size_, 4);
+  EXPECT_EQ(trades2[1].getBid().orderId_, 2);
+  EXPECT_EQ(trades2[1].getBid().size_, 2);
+}
+
+TYPED_TEST(OrderBookTest, AmendUpLosesPriority)
+{
+  this->orderbook_.addOrder(OrderType::GoodTillCancel, OrderId{1}, Side::Buy,
+                            Price{100}, Size{10});
+  this->orderbook_.addOrder(OrderType::GoodTillCancel, OrderId{2}, Side::Buy,
+                            Price{100}, Size{10});
+
+  this->orderbook_.modifyOrder(OrderType::GoodTillCancel, OrderId{1},
+                               Side::Buy, Price{100}, Size{12});
+
+  auto trades = this->orderbook_.addOrder(
+      OrderType::GoodTillCancel, OrderId{3}, Side::Sell, Price{100}, Size{12});
+
+  ASSERT_EQ(trades.size(), 2);
+  EXPECT_EQ(trades[0].getBid().orderId_, 2);
+  EXPECT_EQ(trades[1].getBid().orderId_, 1);
+}
+
 TYPED_TEST(OrderBookTest, BidsAndAsksAreSeparate)
 {
   this->orderbook_.addOrder(OrderType::GoodTillCancel, OrderId{1}, Side::Buy,
@@ -236,3 +452,547 @@ TYPED_TEST(OrderBookTest, ListPolicyCancel)
 
   EXPECT_TRUE(this->orderbook_.empty());
 }
+
+TYPED_TEST(OrderBookTest, CancelMiddleOfQueue)
+{
+  this->orderbook_.addOrder(OrderType::GoodTillCancel, OrderId{1}, Side::Sell,
+                            Price{100}, Size{10});
+  this->orderbook_.addOrder(OrderType::GoodTillCancel, OrderId{2}, Side::Sell,
+                            Price{100}, Size{10});
+  this->orderbook_.addOrder(OrderType::GoodTillCancel, OrderId{3}, Side::Sell,
+                            Price{100}, Size{10});
+
+  this->orderbook_.cancelOrder(OrderId{2});
+
+  auto trades = this->orderbook_.addOrder(OrderType::GoodTillCancel, OrderId{4},
+                                          Side::Buy, Price{100}, Size{30});
+
+  ASSERT_EQ(trades.size(), 2);
+  EXPECT_EQ(trades[0].getAsk().orderId_, 1);
+  EXPECT_EQ(trades[1].getAsk().orderId_, 3);
+  EXPECT_EQ(trades[1].getBid().size_, 10);
+}
+
+TYPED_TEST(OrderBookTest, QueueSurvivesHeavyCancels)
+{
+  for (OrderId id = 1; id <= 20; ++id)
+  {
+    this->orderbook_.addOrder(OrderType::GoodTillCancel, id, Side::Sell,
+                              Price{100}, Size{2});
+  }
+  for (OrderId id = 2; id <= 20; id += 2)
+  {
+    this->orderbook_.cancelOrder(id);
+  }
+  this->orderbook_.addOrder(OrderType::AllOrNone, OrderId{21}, Side::Sell,
+                            Price{100}, Size{50});
+  for (OrderId id = 22; id <= 30; ++id)
+  {
+    this->orderbook_.addOrder(OrderType::GoodTillCancel, id, Side::Sell,
+                              Price{100}, Size{2});
+  }
+  this->orderbook_.modifyOrder(OrderType::GoodTillCancel, OrderId{3},
+                               Side::Sell, Price{100}, Size{1});
+
+  auto trades = this->orderbook_.addOrder(OrderType::FillAndKill, OrderId{31},
+                                          Side::Buy, Price{100}, Size{37});
+
+  std::vector<OrderId> expected;
+  for (OrderId id = 1; id <= 19; id += 2)
+  {
+    expected.push_back(id);
+  }
+  for (OrderId id = 22; id <= 30; ++id)
+  {
+    expected.push_back(id);
+  }
+
+  ASSERT_EQ(trades.size(), expected.size());
+  for (std::size_t i = 0; i < trades.size(); ++i)
+  {
+    EXPECT_EQ(trades[i].getAsk().orderId_, expected[i]);
+  }
+  EXPECT_EQ(trades[1].getAsk().size_, 1);
+
+  // Only the AllOrNone order is left
+  auto rest = this->orderbook_.addOrder(OrderType::FillAndKill, OrderId{32},
+                                        Side::Buy, Price{100}, Size{50});
+  ASSERT_EQ(rest.size(), 1);
+  EXPECT_EQ(rest[0].getAsk().orderId_, 21);
+}
+
+TYPED_TEST(OrderBookTest, LevelHandlesSurviveLevelChurn)
+{
+  // Levels arrive out of price order so vector levels shift under the
+  // handles already given out
+  for (Price price : {105, 101, 109, 103, 107})
+  {
+    auto id = static_cast<OrderId>(price);
+    this->orderbook_.addOrder(OrderType::GoodTillCancel, id, Side::Sell,
+                              price, Size{1});
+    this->orderbook_.addOrder(OrderType::GoodTillCancel, id + 100, Side::Sell,
+                              price, Size{2});
+  }
+
+  this->orderbook_.cancelOrder(OrderId{103});
+  this->orderbook_.cancelOrder(OrderId{203});
+  this->orderbook_.cancelOrder(OrderId{105});
+  this->orderbook_.addOrder(OrderType::GoodTillCancel, OrderId{104},
+                            Side::Sell, Price{104}, Size{4});
+  this->orderbook_.modifyOrder(OrderType::GoodTillCancel, OrderId{207},
+                               Side::Sell, Price{107}, Size{1});
+  this->orderbook_.cancelOrder(OrderId{201});
+
+  auto depth = [&](Side side)
+  {
+    std::vector<std::pair<Price, Size>> levels;
+    this->orderbook_.snapshotDepth(side, 10, [&](Price price, Size size)
+                                   { levels.emplace_back(price, size); });
+    return levels;
+  };
+
+  std::vector<std::pair<Price, Size>> expected{
+      {101, 1}, {104, 4}, {105, 2}, {107, 2}, {109, 3}};
+  EXPECT_EQ(depth(Side::Sell), expected);
+
+  auto trades = this->orderbook_.addOrder(OrderType::FillAndKill, OrderId{1},
+                                          Side::Buy, Price{107}, Size{100});
+  EXPECT_EQ(trades.size(), 5);
+
+  expected = {{109, 3}};
+  EXPECT_EQ(depth(Side::Sell), expected);
+
+  this->orderbook_.cancelOrder(OrderId{209});
+  this->orderbook_.cancelOrder(OrderId{109});
+  EXPECT_TRUE(this->orderbook_.empty());
+  EXPECT_TRUE(depth(Side::Sell).empty());
+  EXPECT_TRUE(depth(Side::Buy).empty());
+}
+
+TEST(PoolOrderAllocatorTest, ReusesSlotsLastInFirstOut)
+{
+  PoolOrderAllocator pool{2};
+
+  auto first = pool.allocate(OrderType::GoodTillCancel, OrderId{1}, Side::Buy,
+                             Price{100}, Size{10});
+  auto second = pool.allocate(OrderType::GoodTillCancel, OrderId{2},
+                              Side::Buy, Price{100}, Size{10});
+  auto third = pool.allocate(OrderType::GoodTillCancel, OrderId{3}, Side::Buy,
+                             Price{100}, Size{10});
+
+  EXPECT_NE(first, second);
+  EXPECT_NE(second, third);
+
+  pool.deallocate(first);
+  pool.deallocate(third);
+
+  auto reused = pool.allocate(OrderType::FillAndKill, OrderId{4}, Side::Sell,
+                              Price{99}, Size{5});
+  EXPECT_EQ(reused, third);
+  EXPECT_EQ(reused->getOrderId(), 4);
+  EXPECT_EQ(reused->getRemainingSize(), 5);
+
+  EXPECT_EQ(pool.allocate(OrderType::GoodTillCancel, OrderId{5}, Side::Buy,
+                          Price{100}, Size{10}),
+            first);
+
+  pool.deallocate(second);
+}
+
+TYPED_TEST(OrderBookTest, WideSpreadPricePriority)
+{
+  this->orderbook_.addOrder(OrderType::GoodTillCancel, OrderId{1}, Side::Sell,
+                            Price{100}, Size{10});
+  this->orderbook_.addOrder(OrderType::GoodTillCancel, OrderId{2}, Side::Sell,
+                            Price{3000}, Size{10});
+  this->orderbook_.addOrder(OrderType::GoodTillCancel, OrderId{3}, Side::Sell,
+                            Price{1500}, Size{10});
+  this->orderbook_.addOrder(OrderType::GoodTillCancel, OrderId{4}, Side::Buy,
+                            Price{50}, Size{10});
+  this->orderbook_.addOrder(OrderType::GoodTillCancel, OrderId{5}, Side::Buy,
+                            Price{1}, Size{10});
+
+  auto trades = this->orderbook_.addOrder(
+      OrderType::Market, OrderId{6}, Side::Buy, Price{MARKET_PRICE}, Size{30});
+
+  ASSERT_EQ(trades.size(), 3);
+  EXPECT_EQ(trades[0].getAsk().orderId_, 1);
+  EXPECT_EQ(trades[1].getAsk().orderId_, 3);
+  EXPECT_EQ(trades[2].getAsk().orderId_, 2);
+  EXPECT_EQ(trades[2].getAsk().price_, 3000);
+
+  auto trades2 = this->orderbook_.addOrder(
+      OrderType::Market, OrderId{7}, Side::Sell, Price{MARKET_PRICE}, Size{20});
+
+  ASSERT_EQ(trades2.size(), 2);
+  EXPECT_EQ(trades2[0].getBid().orderId_, 4);
+  EXPECT_EQ(trades2[1].getBid().orderId_, 5);
+  EXPECT_TRUE(this->orderbook_.empty());
+}
+
+TYPED_TEST(OrderBookTest, TradeSinkReceivesExecutions)
+{
+  this->orderbook_.addOrder(OrderType::GoodTillCancel, OrderId{1}, Side::Sell,
+                            Price{100}, Size{10});
+  this->orderbook_.addOrder(OrderType::GoodTillCancel, OrderId{2}, Side::Sell,
+                            Price{101}, Size{10});
+
+  std::array<Trade, 1> storage;
+  SpanTradeSink sink{storage};
+
+  this->orderbook_.addOrder(OrderType::GoodTillCancel, OrderId{3}, Side::Buy,
+                            Price{101}, Size{15}, sink);
+
+  EXPECT_EQ(sink.count(), 2);
+  EXPECT_TRUE(sink.overflowed());
+  ASSERT_EQ(sink.trades().size(), 1);
+  EXPECT_EQ(sink.trades()[0].getAsk().orderId_, 1);
+  EXPECT_EQ(sink.trades()[0].getBid().size_, 10);
+
+  std::size_t executed = 0;
+  this->orderbook_.modifyOrder(OrderType::GoodTillCancel, OrderId{3},
+                               Side::Sell, Price{101}, Size{5},
+                               [&](const Trade &) { ++executed; });
+
+  EXPECT_EQ(executed, 0);
+
+  auto trades = this->orderbook_.addOrder(OrderType::GoodTillCancel, OrderId{4},
+                                          Side::Buy, Price{101}, Size{10});
+  ASSERT_EQ(trades.size(), 2);
+  EXPECT_EQ(trades[0].getAsk().orderId_, 2);
+  EXPECT_EQ(trades[0].getBid().size_, 5);
+  EXPECT_EQ(trades[1].getAsk().orderId_, 3);
+}
+
+TYPED_TEST(OrderBookTest, TypedAddOrder)
+{
+  this->orderbook_.template addOrder<OrderType::GoodTillCancel>(
+      OrderId{1}, Side::Sell, Price{100}, Size{10});
+  this->orderbook_.template addOrder<OrderType::AllOrNone>(
+      OrderId{2}, Side::Sell, Price{100}, Size{20});
+
+  auto fok = this->orderbook_.template addOrder<OrderType::FillOrKill>(
+      OrderId{3}, Side::Buy, Price{100}, Size{15});
+  EXPECT_TRUE(fok.empty());
+
+  auto fak = this->orderbook_.template addOrder<OrderType::FillAndKill>(
+      OrderId{4}, Side::Buy, Price{100}, Size{15});
+  ASSERT_EQ(fak.size(), 1);
+  EXPECT_EQ(fak[0].getAsk().orderId_, 1);
+
+  auto market = this->orderbook_.template addOrder<OrderType::Market>(
+      OrderId{5}, Side::Buy, Price{MARKET_PRICE}, Size{20});
+  ASSERT_EQ(market.size(), 1);
+  EXPECT_EQ(market[0].getAsk().orderId_, 2);
+  EXPECT_TRUE(this->orderbook_.empty());
+}
+
+TYPED_TEST(OrderBookTest, GoodForDayExpiresAtSessionClose)
+{
+  this->orderbook_.setSessionClose(Timestamp{1000});
+
+  // Level 100 holds only GoodForDay orders, 101 a mix
+  this->orderbook_.addOrder(OrderType::GoodForDay, OrderId{1}, Side::Sell,
+                            Price{100}, Size{10});
+  this->orderbook_.addOrder(OrderType::GoodForDay, OrderId{2}, Side::Sell,
+                            Price{100}, Size{5});
+  this->orderbook_.addOrder(OrderType::GoodForDay, OrderId{3}, Side::Sell,
+                            Price{101}, Size{7});
+  this->orderbook_.addOrder(OrderType::GoodTillCancel, OrderId{4}, Side::Sell,
+                            Price{101}, Size{3});
+  this->orderbook_.addOrder(OrderType::GoodForDay, OrderId{5}, Side::Buy,
+                            Price{99}, Size{8});
+
+  // Placed for the next session
+  this->orderbook_.setSessionClose(Timestamp{2000});
+  this->orderbook_.addOrder(OrderType::GoodForDay, OrderId{6}, Side::Buy,
+                            Price{98}, Size{4});
+
+  EXPECT_EQ(this->orderbook_.expire(Timestamp{999}), 0);
+  EXPECT_EQ(this->orderbook_.expire(Timestamp{1000}), 4);
+  EXPECT_EQ(this->orderbook_.expire(Timestamp{1500}), 0);
+
+  auto depth = [&](Side side)
+  {
+    std::vector<std::pair<Price, Size>> levels;
+    this->orderbook_.snapshotDepth(side, 10, [&](Price price, Size size)
+                                   { levels.emplace_back(price, size); });
+    return levels;
+  };
+
+  EXPECT_EQ(depth(Side::Sell), (std::vector<std::pair<Price, Size>>{{101, 3}}));
+  EXPECT_EQ(depth(Side::Buy), (std::vector<std::pair<Price, Size>>{{98, 4}}));
+
+  auto trades = this->orderbook_.addOrder(OrderType::FillAndKill, OrderId{7},
+                                          Side::Buy, Price{101}, Size{10});
+  ASSERT_EQ(trades.size(), 1);
+  EXPECT_EQ(trades[0].getAsk().orderId_, 4);
+
+  EXPECT_EQ(this->orderbook_.expire(Timestamp{2000}), 1);
+  EXPECT_TRUE(this->orderbook_.empty());
+}
+
+TYPED_TEST(OrderBookTest, GoodForDayLeavingEarlyIsNotExpired)
+{
+  this->orderbook_.setSessionClose(Timestamp{1000});
+
+  this->orderbook_.addOrder(OrderType::GoodForDay, OrderId{1}, Side::Sell,
+                            Price{100}, Size{10});
+  this->orderbook_.addOrder(OrderType::GoodForDay, OrderId{2}, Side::Sell,
+                            Price{100}, Size{10});
+  this->orderbook_.addOrder(OrderType::GoodForDay, OrderId{3}, Side::Sell,
+                            Price{100}, Size{10});
+
+  // Filled, cancelled and turned into GoodTillCancel
+  this->orderbook_.addOrder(OrderType::FillAndKill, OrderId{4}, Side::Buy,
+                            Price{100}, Size{10});
+  this->orderbook_.cancelOrder(OrderId{2});
+  this->orderbook_.modifyOrder(OrderType::GoodTillCancel, OrderId{3},
+                               Side::Sell, Price{100}, Size{10});
+
+  // Reuses an id whose GoodForDay order already left, for the next session
+  this->orderbook_.setSessionClose(Timestamp{2000});
+  this->orderbook_.addOrder(OrderType::GoodForDay, OrderId{2}, Side::Sell,
+                            Price{100}, Size{5});
+
+  EXPECT_EQ(this->orderbook_.expire(Timestamp{1000}), 0);
+
+  std::vector<std::pair<Price, Size>> asks;
+  this->orderbook_.snapshotDepth(Side::Sell, 10, [&](Price price, Size size)
+                                 { asks.emplace_back(price, size); });
+  EXPECT_EQ(asks, (std::vector<std::pair<Price, Size>>{{100, 15}}));
+
+  EXPECT_EQ(this->orderbook_.expire(Timestamp{2000}), 1);
+  this->orderbook_.cancelOrder(OrderId{3});
+  EXPECT_TRUE(this->orderbook_.empty());
+}
+
+TEST(AllOrNoneFreeBookTest, RejectsAllOrNone)
+{
+  OrderBook<ArrayLevelPolicy, IntrusiveOrderPolicy, PoolOrderAllocator,
+            FlatOrderIndex, NullDepthListener, NullOrderEventListener,
+            NullJournal, NullLatencyRecorder, false>
+      orderbook;
+
+  orderbook.addOrder(OrderType::GoodTillCancel, OrderId{1}, Side::Sell,
+                     Price{100}, Size{10});
+  orderbook.addOrder(OrderType::AllOrNone, OrderId{2}, Side::Sell, Price{100},
+                     Size{5});
+  auto swept = orderbook.addOrder(OrderType::FillAndKill, OrderId{3},
+                                  Side::Buy, Price{100}, Size{15});
+  ASSERT_EQ(swept.size(), 1);
+  EXPECT_EQ(swept[0].getAsk().orderId_, 1);
+  EXPECT_TRUE(orderbook.empty());
+
+  orderbook.addOrder(OrderType::GoodTillCancel, OrderId{1}, Side::Sell,
+                     Price{100}, Size{10});
+  orderbook.modifyOrder(OrderType::AllOrNone, OrderId{1}, Side::Sell,
+                        Price{100}, Size{10});
+  EXPECT_TRUE(orderbook.empty());
+
+  orderbook.addOrder(OrderType::GoodTillCancel, OrderId{4}, Side::Sell,
+                     Price{100}, Size{10});
+  auto trades = orderbook.addOrder(OrderType::FillOrKill, OrderId{5},
+                                   Side::Buy, Price{100}, Size{10});
+  ASSERT_EQ(trades.size(), 1);
+  EXPECT_EQ(trades[0].getAsk().orderId_, 4);
+}
+
+// A window of at most 64 ticks
+template <typename Compare, typename OrderContainer>
+using NarrowArrayLevelPolicy =
+    BasicArrayLevelPolicy<Compare, OrderContainer, 16, 1, 64>;
+
+TEST(ArrayLevelPolicyTest, RejectsPricesOutsideItsWindow)
+{
+  OrderBook<NarrowArrayLevelPolicy, IntrusiveOrderPolicy> orderbook;
+
+  auto depth = [&](Side side)
+  {
+    std::vector<std::pair<Price, Size>> levels;
+    orderbook.snapshotDepth(side, 100, [&](Price price, Size size)
+                            { levels.emplace_back(price, size); });
+    return levels;
+  };
+
+  orderbook.addOrder(OrderType::GoodTillCancel, OrderId{1}, Side::Buy,
+                     Price{100}, Size{10});
+  orderbook.addOrder(OrderType::GoodTillCancel, OrderId{2}, Side::Sell,
+                     Price{150}, Size{10});
+
+  // Would stretch the window to 65 ticks, so rejected before matching
+  orderbook.addOrder(OrderType::GoodTillCancel, OrderId{3}, Side::Buy,
+                     Price{164}, Size{20});
+  orderbook.addOrder(OrderType::GoodForDay, OrderId{4}, Side::Buy, Price{36},
+                     Size{20});
+  EXPECT_EQ(depth(Side::Buy), (std::vector<std::pair<Price, Size>>{{100, 10}}));
+  EXPECT_EQ(depth(Side::Sell),
+            (std::vector<std::pair<Price, Size>>{{150, 10}}));
+
+  // Never rests, so is not held to the window
+  auto trades = orderbook.addOrder(OrderType::FillAndKill, OrderId{5},
+                                   Side::Buy, Price{164}, Size{20});
+  ASSERT_EQ(trades.size(), 1);
+  EXPECT_EQ(trades[0].getAsk().orderId_, 2);
+
+  orderbook.addOrder(OrderType::GoodTillCancel, OrderId{6}, Side::Buy,
+                     Price{163}, Size{5});
+  EXPECT_EQ(depth(Side::Buy),
+            (std::vector<std::pair<Price, Size>>{{163, 5}, {100, 10}}));
+
+  // The window follows the book once the far prices leave
+  orderbook.cancelOrder(OrderId{1});
+  orderbook.cancelOrder(OrderId{6});
+  orderbook.addOrder(OrderType::GoodTillCancel, OrderId{7}, Side::Buy,
+                     Price{1000}, Size{5});
+  EXPECT_EQ(depth(Side::Buy), (std::vector<std::pair<Price, Size>>{{1000, 5}}));
+}
+
+template <typename OrderContainer>
+class SlotOrderPolicyTest : public testing::Test
+{
+};
+
+using SlotOrderPolicies =
+    ::testing::Types<TombstoneDequeOrderPolicy, TombstoneVectorOrderPolicy,
+                     ColumnarOrderPolicy>;
+TYPED_TEST_SUITE(SlotOrderPolicyTest, SlotOrderPolicies);
+
+TYPED_TEST(SlotOrderPolicyTest, EraseCompactsOnceTombstonesOutnumber)
+{
+  std::vector<std::unique_ptr<Order>> orders;
+  TypeParam queue;
+  for (OrderId id = 0; id < 10; ++id)
+  {
+    orders.push_back(std::make_unique<Order>(
+        OrderType::GoodTillCancel, id, Side::Sell, Price{100}, Size{1}));
+    queue.insert(orders.back().get());
+  }
+
+  // Tombstones behind the head, which no sweep would clear
+  for (std::size_t i = 1; i < 6; ++i)
+  {
+    EXPECT_EQ(*queue.erase(orders[i].get()), orders[i + 1].get());
+  }
+  EXPECT_EQ(queue.orders_.size(), 10);
+
+  // The sixth tips them over, and the way on survives the compaction
+  auto next = queue.erase(orders[6].get());
+  EXPECT_EQ(queue.orders_.size(), 4);
+  ASSERT_NE(next, queue.end());
+  EXPECT_EQ(*next, orders[7].get());
+
+  std::vector<OrderId> ids;
+  for (auto order : queue)
+  {
+    ids.push_back(order->getOrderId());
+  }
+  EXPECT_EQ(ids, (std::vector<OrderId>{0, 7, 8, 9}));
+
+  EXPECT_EQ(queue.erase(orders[9].get()), queue.end());
+}
+
+// Four prices to a chunk, so chunks split and merge all the time
+template <typename Compare, typename OrderContainer>
+using SmallChunkedLevelPolicy =
+    BasicChunkedLevelPolicy<Compare, OrderContainer, 4>;
+
+TEST(ChunkedLevelPolicyTest, ChunksStayFilledAsLevelsLeave)
+{
+  for (bool bestFirst : {true, false})
+  {
+    SmallChunkedLevelPolicy<std::less<Price>, IntrusiveOrderPolicy> asks;
+
+    std::vector<std::unique_ptr<Order>> orders;
+    for (Price price = 1; price <= 64; ++price)
+    {
+      orders.push_back(std::make_unique<Order>(OrderType::GoodTillCancel,
+                                               static_cast<OrderId>(price),
+                                               Side::Sell, price, Size{1}));
+      asks.add(orders.back().get());
+    }
+    if (!bestFirst)
+    {
+      std::reverse(orders.begin(), orders.end());
+    }
+
+    // No two neighbouring chunks fit in half a chunk between them, which
+    // bounds the chunks at two for every three levels
+    std::size_t levels = orders.size();
+    for (const auto &order : orders)
+    {
+      if (order->getPrice() % 4 == 0)
+        continue;
+
+      asks.cancel(order.get());
+      --levels;
+      EXPECT_LE(asks.chunkCount(), 2 * levels / 3 + 1);
+    }
+
+    std::vector<Price> prices;
+    for (const auto &level : asks)
+    {
+      prices.push_back(level.price_);
+    }
+    EXPECT_EQ(prices.size(), 16);
+    EXPECT_TRUE(std::is_sorted(prices.begin(), prices.end()));
+  }
+}
+
+TEST(ChunkedLevelPolicyTest, MatchesMapLevelPolicy)
+{
+  OrderBook<MapLevelPolicy, IntrusiveOrderPolicy> map;
+  OrderBook<SmallChunkedLevelPolicy, IntrusiveOrderPolicy> chunked;
+
+  std::mt19937_64 rng{11};
+  std::uniform_int_distribution<Price> price{80, 120};
+  std::uniform_int_distribution<Size> size{1, 30};
+  std::uniform_int_distribution<int> action{0, 9};
+
+  auto depth = [](const auto &book, Side side)
+  {
+    std::vector<std::pair<Price, Size>> levels;
+    book.snapshotDepth(side, 1000, [&](Price price, Size size)
+                       { levels.emplace_back(price, size); });
+    return levels;
+  };
+
+  OrderId nextId = 0;
+  for (int step = 0; step < 20000; ++step)
+  {
+    auto draw = action(rng);
+    if (draw < 3 && nextId > 0)
+    {
+      OrderId id = rng() % nextId;
+      map.cancelOrder(id);
+      chunked.cancelOrder(id);
+      continue;
+    }
+
+    Side side = rng() % 2 ? Side::Buy : Side::Sell;
+    // Buys rest low and sells high, crossing now and then
+    Price at = side == Side::Buy ? price(rng) - 5 : price(rng) + 5;
+    auto orderType = draw == 3 ? OrderType::AllOrNone
+                     : draw == 4 ? OrderType::FillAndKill
+                                 : OrderType::GoodTillCancel;
+    auto volume = size(rng);
+
+    auto expected = map.addOrder(orderType, nextId, side, at, volume);
+    auto actual = chunked.addOrder(orderType, nextId, side, at, volume);
+    ++nextId;
+
+    ASSERT_EQ(actual.size(), expected.size()) << "step " << step;
+    for (std::size_t i = 0; i < actual.size(); ++i)
+    {
+      ASSERT_EQ(actual[i].getBid().orderId_, expected[i].getBid().orderId_);
+      ASSERT_EQ(actual[i].getAsk().orderId_, expected[i].getAsk().orderId_);
+      ASSERT_EQ(actual[i].getAsk().size_, expected[i].getAsk().size_);
+    }
+
+    if (step % 100 == 0)
+    {
+      ASSERT_EQ(depth(chunked, Side::Buy), depth(map, Side::Buy));
+      ASSERT_EQ(depth(chunked, Side::Sell), depth(map, Side::Sell));
+    }
+  }
+}
@@ -0,0 +1,106 @@
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+#include "orderbook/orderbook.h"
+#include "orderbook/pipeline.h"
+
+using PipelineBook = OrderBook<MapLevelPolicy, IntrusiveOrderPolicy,
+                               PoolOrderAllocator, FlatOrderIndex>;
+
+namespace
+{
+std::vector<CommandResult> collect(OrderPipeline<PipelineBook> &pipeline,
+                                   std::size_t gateway, std::size_t count)
+{
+  std::vector<CommandResult> results;
+  while (results.size() < count)
+  {
+    if (pipeline.pollResults(gateway, count - results.size(),
+                             [&](const CommandResult &result)
+                             { results.push_back(result); }) == 0)
+    {
+      std::this_thread::yield();
+    }
+  }
+  return results;
+}
+} // namespace
+
+TEST(OrderPipelineTest, ReturnsOneResultPerCommand)
+{
+  OrderPipeline<PipelineBook> pipeline{1, 4};
+
+  pipeline.submit(0, Command{CommandType::Add, OrderType::GoodTillCancel,
+                             Side::Sell, SymbolId{}, OrderId{1}, Price{100},
+                             Size{10}});
+  pipeline.submit(0, Command{CommandType::Add, OrderType::GoodTillCancel,
+                             Side::Sell, SymbolId{}, OrderId{2}, Price{101},
+                             Size{10}});
+  pipeline.submit(0, Command{CommandType::Add, OrderType::GoodTillCancel,
+                             Side::Buy, SymbolId{}, OrderId{3}, Price{101},
+                             Size{15}});
+  pipeline.submit(0, Command{CommandType::Cancel, OrderType::GoodTillCancel,
+                             Side::Sell, SymbolId{}, OrderId{2}, Price{},
+                             Size{}});
+
+  auto results = collect(pipeline, 0, 4);
+
+  for (std::uint64_t i = 0; i < 4; ++i)
+  {
+    EXPECT_EQ(results[i].sequence_, i);
+  }
+  EXPECT_EQ(results[0].trades_, 0);
+  EXPECT_EQ(results[2].orderId_, 3);
+  EXPECT_EQ(results[2].trades_, 2);
+  EXPECT_EQ(results[2].filled_, 15);
+  EXPECT_EQ(results[3].type_, CommandType::Cancel);
+}
+
+TEST(OrderPipelineTest, GatewaysShareOneBook)
+{
+  constexpr std::size_t pairs = 10000;
+  OrderPipeline<PipelineBook> pipeline{2, 64};
+
+  std::jthread sellers{[&]
+                       {
+                         for (OrderId id = 0; id < pairs; ++id)
+                         {
+                           pipeline.submit(
+                               0, Command{CommandType::Add,
+                                          OrderType::GoodTillCancel,
+                                          Side::Sell, SymbolId{}, 2 * id,
+                                          Price{100}, Size{10}});
+                         }
+                       }};
+
+  std::jthread buyers{[&]
+                      {
+                        for (OrderId id = 0; id < pairs; ++id)
+                        {
+                          pipeline.submit(
+                              1, Command{CommandType::Add,
+                                         OrderType::GoodTillCancel, Side::Buy,
+                                         SymbolId{}, 2 * id + 1, Price{100},
+                                         Size{10}});
+                        }
+                      }};
+
+  // Both lanes are polled, or a full outbound ring would stall matching
+  Size filled = 0;
+  std::size_t results = 0;
+  while (results < 2 * pairs)
+  {
+    for (std::size_t gateway = 0; gateway < 2; ++gateway)
+    {
+      results += pipeline.pollResults(gateway, 64,
+                                      [&](const CommandResult &result)
+                                      { filled += result.filled_; });
+    }
+    std::this_thread::yield();
+  }
+
+  // Only the aggressing side of each cross reports the fill
+  EXPECT_EQ(filled, pairs * 10);
+}
@@ -0,0 +1,35 @@
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "orderbook/slot_table.h"
+
+TEST(SlotTableTest, HandlesStayPutWhilePositionsChange)
+{
+  SlotTable<std::size_t> table;
+
+  auto a = table.acquire(10);
+  auto b = table.acquire(20);
+  EXPECT_NE(a, b);
+
+  table[a] = 11;
+  EXPECT_EQ(table[a], 11);
+  EXPECT_EQ(table[b], 20);
+  EXPECT_EQ(table.size(), 2);
+}
+
+TEST(SlotTableTest, ReusesReleasedSlots)
+{
+  SlotTable<std::size_t> table;
+
+  auto a = table.acquire(1);
+  table.acquire(2);
+  table.release(a);
+  EXPECT_EQ(table.size(), 1);
+
+  auto c = table.acquire(3);
+  EXPECT_EQ(c, a);
+  EXPECT_EQ(table[c], 3);
+  EXPECT_EQ(table.size(), 2);
+}
@@ -0,0 +1,229 @@
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "orderbook/orderbook.h"
+
+using SnapshotBookPolicies =
+    ::testing::Types<OrderBook<MapLevelPolicy, DequeOrderPolicy>,
+                     OrderBook<MapLevelPolicy, ListOrderPolicy>,
+                     OrderBook<MapLevelPolicy, VectorOrderPolicy>,
+                     OrderBook<MapLevelPolicy, IntrusiveOrderPolicy>,
+                     OrderBook<VectorLevelPolicy, DequeOrderPolicy>,
+                     OrderBook<VectorLevelPolicy, ListOrderPolicy>,
+                     OrderBook<VectorLevelPolicy, VectorOrderPolicy>,
+                     OrderBook<VectorLevelPolicy, IntrusiveOrderPolicy>,
+                     OrderBook<ListLevelPolicy, DequeOrderPolicy>,
+                     OrderBook<ListLevelPolicy, ListOrderPolicy>,
+                     OrderBook<ListLevelPolicy, VectorOrderPolicy>,
+                     OrderBook<ListLevelPolicy, IntrusiveOrderPolicy>,
+                     OrderBook<ArrayLevelPolicy, DequeOrderPolicy>,
+                     OrderBook<ArrayLevelPolicy, ListOrderPolicy>,
+                     OrderBook<ArrayLevelPolicy, VectorOrderPolicy>,
+                     OrderBook<ArrayLevelPolicy, IntrusiveOrderPolicy>,
+                     OrderBook<MapLevelPolicy, ColumnarOrderPolicy>,
+                     OrderBook<ArrayLevelPolicy, ColumnarOrderPolicy>,
+                     OrderBook<MapLevelPolicy, TombstoneDequeOrderPolicy>,
+                     OrderBook<ArrayLevelPolicy, TombstoneVectorOrderPolicy>,
+                     OrderBook<ChunkedLevelPolicy, ListOrderPolicy>,
+                     OrderBook<ChunkedLevelPolicy, IntrusiveOrderPolicy>,
+                     OrderBook<MapLevelPolicy, IntrusiveOrderPolicy,
+                               PoolOrderAllocator, FlatOrderIndex>,
+                     OrderBook<ArrayLevelPolicy, IntrusiveOrderPolicy,
+                               PoolOrderAllocator, FlatOrderIndex>>;
+
+template <typename OrderBookPolicy> class SnapshotTest : public testing::Test
+{
+public:
+  using Levels = std::vector<std::pair<Price, Size>>;
+
+  void SetUp() override
+  {
+    orderbook_.addOrder(OrderType::GoodTillCancel, OrderId{1}, Side::Buy,
+                        Price{100}, Size{10});
+    orderbook_.addOrder(OrderType::AllOrNone, OrderId{2}, Side::Buy,
+                        Price{100}, Size{20});
+    orderbook_.addOrder(OrderType::GoodForDay, OrderId{3}, Side::Buy,
+                        Price{100}, Size{5});
+    orderbook_.addOrder(OrderType::GoodTillCancel, OrderId{4}, Side::Buy,
+                        Price{98}, Size{7});
+    orderbook_.addOrder(OrderType::GoodTillCancel, OrderId{5}, Side::Sell,
+                        Price{103}, Size{8});
+    orderbook_.addOrder(OrderType::GoodTillCancel, OrderId{6}, Side::Sell,
+                        Price{101}, Size{4});
+
+    // Leaves order 1 partially filled at the front of its queue
+    orderbook_.addOrder(OrderType::FillAndKill, OrderId{7}, Side::Sell,
+                        Price{100}, Size{3});
+  }
+
+  static Levels depth(const OrderBookPolicy &book, Side side)
+  {
+    Levels levels;
+    book.snapshotDepth(side, 100, [&](Price price, Size size)
+                       { levels.emplace_back(price, size); });
+    return levels;
+  }
+
+  OrderBookPolicy orderbook_;
+};
+
+TYPED_TEST_SUITE(SnapshotTest, SnapshotBookPolicies);
+
+TYPED_TEST(SnapshotTest, RestoreRebuildsLevels)
+{
+  TypeParam restored;
+  restored.restore(this->orderbook_.snapshot());
+
+  EXPECT_EQ(this->depth(restored, Side::Buy),
+            this->depth(this->orderbook_, Side::Buy));
+  EXPECT_EQ(this->depth(restored, Side::Sell),
+            this->depth(this->orderbook_, Side::Sell));
+  EXPECT_EQ(this->depth(restored, Side::Buy),
+            (typename TestFixture::Levels{{100, 32}, {98, 7}}));
+}
+
+TYPED_TEST(SnapshotTest, RestoreKeepsQueuePriority)
+{
+  TypeParam restored;
+  restored.restore(this->orderbook_.snapshot());
+
+  // The AllOrNone order is too big and is skipped, as before the snapshot
+  auto trades = restored.addOrder(OrderType::FillAndKill, OrderId{8},
+                                  Side::Sell, Price{98}, Size{15});
+
+  ASSERT_EQ(trades.size(), 3);
+  EXPECT_EQ(trades[0].getBid().orderId_, 1);
+  EXPECT_EQ(trades[0].getBid().size_, 7);
+  EXPECT_EQ(trades[1].getBid().orderId_, 3);
+  EXPECT_EQ(trades[1].getBid().size_, 5);
+  EXPECT_EQ(trades[2].getBid().orderId_, 4);
+  EXPECT_EQ(trades[2].getBid().size_, 3);
+}
+
+TYPED_TEST(SnapshotTest, RestoredGoodForDayExpiresAtSessionClose)
+{
+  TypeParam restored;
+  restored.setSessionClose(Timestamp{1000});
+  restored.restore(this->orderbook_.snapshot());
+
+  EXPECT_EQ(restored.expire(Timestamp{1000}), 1);
+  EXPECT_EQ(this->depth(restored, Side::Buy),
+            (typename TestFixture::Levels{{100, 27}, {98, 7}}));
+}
+
+TYPED_TEST(SnapshotTest, RestoredOrdersCanBeCancelled)
+{
+  TypeParam restored;
+  restored.restore(this->orderbook_.snapshot());
+
+  restored.cancelOrder(OrderId{2});
+  restored.cancelOrder(OrderId{6});
+
+  EXPECT_EQ(this->depth(restored, Side::Buy),
+            (typename TestFixture::Levels{{100, 12}, {98, 7}}));
+  EXPECT_EQ(this->depth(restored, Side::Sell),
+            (typename TestFixture::Levels{{103, 8}}));
+}
+
+TYPED_TEST(SnapshotTest, EmptyBookRoundTrips)
+{
+  TypeParam empty;
+  auto snapshot = empty.snapshot();
+  EXPECT_EQ(snapshot.size(), SnapshotFormat::headerSize_);
+
+  TypeParam restored;
+  restored.restore(snapshot);
+  EXPECT_TRUE(restored.empty());
+}
+
+TYPED_TEST(SnapshotTest, RejectsBadInput)
+{
+  auto snapshot = this->orderbook_.snapshot();
+
+  EXPECT_THROW(this->orderbook_.restore(snapshot), std::runtime_error);
+
+  TypeParam truncated;
+  EXPECT_THROW(
+      truncated.restore(std::span{snapshot}.first(snapshot.size() - 1)),
+      std::runtime_error);
+  EXPECT_TRUE(truncated.empty());
+
+  snapshot[0] = std::byte{0};
+  TypeParam corrupt;
+  EXPECT_THROW(corrupt.restore(snapshot), std::runtime_error);
+}
+
+TYPED_TEST(SnapshotTest, RejectsCorruptLevels)
+{
+  using Bid = std::tuple<Price, Size, std::uint8_t>;
+
+  // One bid level for each bid, holding one order
+  auto bids = [](std::vector<Bid> orders)
+  {
+    std::vector<std::byte> snapshot(
+        SnapshotFormat::headerSize_ +
+        orders.size() *
+            (SnapshotFormat::levelSize_ + SnapshotFormat::orderSize_));
+    SnapshotWriter writer{snapshot};
+    writer.write(SnapshotFormat::magic_);
+    writer.write(SnapshotFormat::version_);
+    writer.write(static_cast<std::uint32_t>(orders.size()));
+    writer.write(std::uint32_t{0});
+    writer.write(static_cast<std::uint64_t>(orders.size()));
+
+    OrderId orderId = 1;
+    for (auto [price, size, type] : orders)
+    {
+      writer.write(price);
+      writer.write(std::uint32_t{1});
+      writer.write(orderId++);
+      writer.write(size);
+      writer.write(type);
+    }
+    return snapshot;
+  };
+
+  auto gtc = static_cast<std::uint8_t>(OrderType::GoodTillCancel);
+
+  TypeParam valid;
+  valid.restore(bids({{100, 10, gtc}, {99, 5, gtc}}));
+  EXPECT_EQ(this->depth(valid, Side::Buy),
+            (typename TestFixture::Levels{{100, 10}, {99, 5}}));
+
+  for (const auto &corrupt : {
+           bids({{100, 0, gtc}}),
+           bids({{100, 10, std::uint8_t{200}}}),
+           bids({{100, 10, static_cast<std::uint8_t>(OrderType::Market)}}),
+           bids({{100, 10, gtc}, {100, 5, gtc}}),
+           bids({{99, 10, gtc}, {100, 5, gtc}}),
+       })
+  {
+    TypeParam restored;
+    EXPECT_THROW(restored.restore(corrupt), std::runtime_error);
+    EXPECT_TRUE(restored.empty());
+  }
+}
+
+template <typename Compare, typename OrderContainer>
+using NarrowArrayLevelPolicy =
+    BasicArrayLevelPolicy<Compare, OrderContainer, 16, 1, 64>;
+
+TEST(NarrowArraySnapshotTest, RejectsPricesOutsideTheWindow)
+{
+  OrderBook<MapLevelPolicy, IntrusiveOrderPolicy> wide;
+  wide.addOrder(OrderType::GoodTillCancel, OrderId{1}, Side::Buy, Price{100},
+                Size{10});
+  wide.addOrder(OrderType::GoodTillCancel, OrderId{2}, Side::Buy, Price{1},
+                Size{10});
+
+  OrderBook<NarrowArrayLevelPolicy, IntrusiveOrderPolicy> narrow;
+  EXPECT_THROW(narrow.restore(wide.snapshot()), std::runtime_error);
+  EXPECT_TRUE(narrow.empty());
+}
@@ -0,0 +1,59 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <thread>
+
+#include "orderbook/spsc_ring.h"
+
+TEST(SpscRingTest, FillsToCapacityAndWraps)
+{
+  SpscRing<int> ring{3};
+  ASSERT_EQ(ring.capacity(), 4);
+
+  for (int round = 0; round < 3; ++round)
+  {
+    for (int i = 0; i < 4; ++i)
+    {
+      EXPECT_TRUE(ring.tryPush(round * 4 + i));
+    }
+    EXPECT_FALSE(ring.tryPush(-1));
+    EXPECT_EQ(ring.size(), 4);
+
+    int value = -1;
+    EXPECT_TRUE(ring.tryPop(value));
+    EXPECT_EQ(value, round * 4);
+
+    int expected = round * 4 + 1;
+    EXPECT_EQ(ring.popBatch(8, [&](int v) { EXPECT_EQ(v, expected++); }), 3);
+    EXPECT_TRUE(ring.empty());
+    EXPECT_FALSE(ring.tryPop(value));
+  }
+}
+
+TEST(SpscRingTest, DeliversInOrderAcrossThreads)
+{
+  constexpr std::uint64_t count = 1'000'000;
+  SpscRing<std::uint64_t> ring{64};
+
+  std::jthread producer{[&]
+                        {
+                          for (std::uint64_t i = 0; i < count; ++i)
+                          {
+                            while (!ring.tryPush(i))
+                            {
+                              std::this_thread::yield();
+                            }
+                          }
+                        }};
+
+  std::uint64_t expected = 0;
+  while (expected < count)
+  {
+    if (ring.popBatch(16, [&](std::uint64_t v) { ASSERT_EQ(v, expected++); }) ==
+        0)
+    {
+      std::this_thread::yield();
+    }
+  }
+  EXPECT_TRUE(ring.empty());
+}